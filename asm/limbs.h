@@ -0,0 +1,19 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// limb kernels from limbs.S (x86-64, System V ABI); lengths are in 32-bit limbs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint32_t limbs_asm_add_n(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n);
+uint32_t limbs_asm_sub_n(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n);
+uint32_t limbs_asm_mul_1(uint32_t* r, uint32_t const* a, size_t n, uint32_t b);
+uint32_t limbs_asm_addmul_1(uint32_t* r, uint32_t const* a, size_t n, uint32_t b);
+uint32_t limbs_asm_submul_1(uint32_t* r, uint32_t const* a, size_t n, uint32_t b);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,232 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <map>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include <benchmark/benchmark.h>
+
+#include "../big_accumulator.h"
+#include "../big_integer.h"
+#include "../ci-extra/big_integer_gmp.h"
+
+namespace
+{
+    // operations linear in the operand size run up to 1M limbs, the rest stop earlier
+    // to keep a full run within minutes; BENCH_MAX_LIMBS lowers every limit
+    constexpr int64_t MAX_LINEAR = 1 << 20;
+    constexpr int64_t MAX_MUL = 1 << 16;
+    constexpr int64_t MAX_QUADRATIC = 1 << 13;
+    constexpr int64_t MAX_CUBIC = 1 << 7;
+
+    std::vector<uint32_t> random_limbs(size_t n, std::mt19937& rng)
+    {
+        std::vector<uint32_t> limbs(n);
+        std::generate(limbs.begin(), limbs.end(), std::ref(rng));
+        limbs.back() |= 1;
+        return limbs;
+    }
+
+    template <typename T>
+    T random_number(size_t n, std::mt19937& rng)
+    {
+        std::vector<uint32_t> limbs = random_limbs(n, rng);
+        return T::from_limbs(limbs.data(), limbs.size(), false);
+    }
+
+    template <typename T, typename F>
+    void binary(benchmark::State& state, F f, size_t divisor)
+    {
+        auto n = static_cast<size_t>(state.range(0));
+        std::mt19937 rng(static_cast<uint32_t>(n));
+        T a = random_number<T>(n, rng);
+        T b = random_number<T>(std::max<size_t>(1, n / divisor), rng);
+        for (auto _ : state)
+        {
+            T r = f(a, b);
+            benchmark::DoNotOptimize(r);
+        }
+        state.counters["limbs"] = static_cast<double>(n);
+    }
+
+    template <typename T, typename F>
+    void unary(benchmark::State& state, F f)
+    {
+        auto n = static_cast<size_t>(state.range(0));
+        std::mt19937 rng(static_cast<uint32_t>(n));
+        T a = random_number<T>(n, rng);
+        for (auto _ : state)
+        {
+            auto r = f(a);
+            benchmark::DoNotOptimize(r);
+        }
+        state.counters["limbs"] = static_cast<double>(n);
+    }
+
+    template <typename T>
+    void parse(benchmark::State& state)
+    {
+        auto n = static_cast<size_t>(state.range(0));
+        std::mt19937 rng(static_cast<uint32_t>(n));
+        std::string s = to_string(random_number<T>(n, rng));
+        for (auto _ : state)
+        {
+            T r(s);
+            benchmark::DoNotOptimize(r);
+        }
+        state.counters["limbs"] = static_cast<double>(n);
+    }
+
+    big_integer total(big_accumulator const& sum)
+    {
+        return sum.value();
+    }
+
+    template <typename T>
+    T const& total(T const& sum)
+    {
+        return sum;
+    }
+
+    // sum of many terms of n limbs, accumulated in Sum
+    template <typename T, typename Sum>
+    void sum(benchmark::State& state)
+    {
+        constexpr size_t TERMS = 256;
+        auto n = static_cast<size_t>(state.range(0));
+        std::mt19937 rng(static_cast<uint32_t>(n));
+        std::vector<T> terms;
+        for (size_t i = 0; i != TERMS; ++i)
+            terms.push_back(random_number<T>(n, rng));
+        for (auto _ : state)
+        {
+            Sum s;
+            for (T const& t : terms)
+                s += t;
+            auto r = total(s);
+            benchmark::DoNotOptimize(r);
+        }
+        state.counters["limbs"] = static_cast<double>(n);
+    }
+
+    template <typename T>
+    T larger(T a, T b)
+    {
+        return a < b ? b : a;
+    }
+
+    // code that passes values around by value: every call copies its arguments and its result
+    template <typename T>
+    void by_value(benchmark::State& state)
+    {
+        constexpr size_t VALUES = 64;
+        auto n = static_cast<size_t>(state.range(0));
+        std::mt19937 rng(static_cast<uint32_t>(n));
+        std::vector<T> values;
+        for (size_t i = 0; i != VALUES; ++i)
+            values.push_back(random_number<T>(n, rng));
+        reset_big_integer_stats();
+        for (auto _ : state)
+        {
+            std::vector<T> copy = values;
+            T best = copy[0];
+            for (T const& v : copy)
+                best = larger(best, v);
+            benchmark::DoNotOptimize(best);
+        }
+        // zero unless built with ENABLE_STATS
+        state.counters["bytes_allocated"] = benchmark::Counter(
+            static_cast<double>(get_big_integer_stats().allocated_bytes), benchmark::Counter::kAvgIterations);
+        state.counters["limbs"] = static_cast<double>(n);
+    }
+
+    int64_t limit(int64_t max)
+    {
+        char const* env = std::getenv("BENCH_MAX_LIMBS");
+        return env == nullptr ? max : std::min(max, static_cast<int64_t>(std::atoll(env)));
+    }
+
+    template <typename T>
+    void register_all(std::string const& impl)
+    {
+        auto add = [impl](std::string const& op, int64_t max, void (*f)(benchmark::State&)) {
+            benchmark::RegisterBenchmark((op + "/" + impl).c_str(), f)->RangeMultiplier(8)->Range(1, limit(max));
+        };
+
+        add("add", MAX_LINEAR, [](benchmark::State& s) { binary<T>(s, [](T const& a, T const& b) { return a + b; }, 1); });
+        add("sub", MAX_LINEAR, [](benchmark::State& s) { binary<T>(s, [](T const& a, T const& b) { return a - b; }, 1); });
+        add("and", MAX_LINEAR, [](benchmark::State& s) { binary<T>(s, [](T const& a, T const& b) { return a & b; }, 1); });
+        add("or", MAX_LINEAR, [](benchmark::State& s) { binary<T>(s, [](T const& a, T const& b) { return a | b; }, 1); });
+        add("xor", MAX_LINEAR, [](benchmark::State& s) { binary<T>(s, [](T const& a, T const& b) { return a ^ b; }, 1); });
+        add("shl", MAX_LINEAR, [](benchmark::State& s) { unary<T>(s, [](T const& a) { return a << 1000; }); });
+        add("shr", MAX_LINEAR, [](benchmark::State& s) { unary<T>(s, [](T const& a) { return a >> 1000; }); });
+        add("mul", MAX_MUL, [](benchmark::State& s) { binary<T>(s, [](T const& a, T const& b) { return a * b; }, 1); });
+        add("div", MAX_QUADRATIC, [](benchmark::State& s) { binary<T>(s, [](T const& a, T const& b) { return a / b; }, 2); });
+        add("mod", MAX_QUADRATIC, [](benchmark::State& s) { binary<T>(s, [](T const& a, T const& b) { return a % b; }, 2); });
+        add("to_string", MAX_QUADRATIC, [](benchmark::State& s) { unary<T>(s, [](T const& a) { return to_string(a); }); });
+        add("parse", MAX_QUADRATIC, parse<T>);
+        add("sum", MAX_MUL, sum<T, T>);
+        add("by_value", MAX_MUL, by_value<T>);
+        add("pow_mod", MAX_CUBIC, [](benchmark::State& s) {
+            unary<T>(s, [](T const& a) { return pow_mod(a + 2, a, a | 1); });
+        });
+    }
+
+    // prints the usual console output, then big_integer time / GMP time for every operation and size
+    struct ratio_reporter : benchmark::ConsoleReporter
+    {
+        void ReportRuns(std::vector<Run> const& reports) override
+        {
+            ConsoleReporter::ReportRuns(reports);
+            for (Run const& run : reports)
+            {
+                if (run.run_type != Run::RT_Iteration || run.error_occurred)
+                    continue;
+                std::string name = run.benchmark_name();
+                size_t size_pos = name.rfind('/');
+                size_t impl_pos = name.rfind('/', size_pos - 1);
+                std::string key = name.substr(0, impl_pos) + name.substr(size_pos);
+                times[key][name.substr(impl_pos + 1, size_pos - impl_pos - 1)] = run.GetAdjustedRealTime();
+                if (std::find(order.begin(), order.end(), key) == order.end())
+                    order.push_back(key);
+            }
+        }
+
+        void Finalize() override
+        {
+            std::ostream& out = GetOutputStream();
+            out << "\n" << std::left << std::setw(24) << "operation" << "big_integer / gmp\n";
+            for (std::string const& key : order)
+            {
+                std::map<std::string, double>& t = times[key];
+                if (t.count("big_integer") == 0 || t.count("gmp") == 0 || t["gmp"] == 0)
+                    continue;
+                out << std::left << std::setw(24) << key << std::fixed << std::setprecision(2)
+                    << t["big_integer"] / t["gmp"] << "\n";
+            }
+            ConsoleReporter::Finalize();
+        }
+
+        std::map<std::string, std::map<std::string, double>> times;
+        std::vector<std::string> order;
+    };
+} // namespace
+
+int main(int argc, char** argv)
+{
+    register_all<big_integer>("big_integer");
+    register_all<big_integer_gmp>("gmp");
+    benchmark::RegisterBenchmark("sum/big_accumulator", sum<big_integer, big_accumulator>)
+        ->RangeMultiplier(8)
+        ->Range(1, limit(MAX_MUL));
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+        return 1;
+    ratio_reporter reporter;
+    benchmark::RunSpecifiedBenchmarks(&reporter);
+    benchmark::Shutdown();
+    return 0;
+}
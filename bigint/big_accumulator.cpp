@@ -0,0 +1,91 @@
+#include "big_accumulator.h"
+#include <algorithm>
+
+namespace {
+    // a lane starts below 2^32 in magnitude and every addition moves it by less than 2^32,
+    // so after this many additions it is still far from 2^63
+    uint32_t static constexpr default_max_pending = 1u << 30;
+
+    // adds the carry to a lane and splits off the low limb, leaving the signed carry to the next lane
+    uint32_t split(uint64_t lane, int64_t& carry) {
+        uint64_t sum = lane + static_cast<uint64_t>(carry);
+        uint32_t low = static_cast<uint32_t>(sum);
+        carry = (static_cast<int64_t>(sum) - low) / (int64_t(1) << 32);
+        return low;
+    }
+}
+
+big_accumulator::big_accumulator() :
+    lanes(1, 0),
+    pending(0),
+    max_pending(default_max_pending) {}
+
+big_accumulator::big_accumulator(big_integer const& init) : big_accumulator() {
+    add(init, false);
+}
+
+big_accumulator::big_accumulator(big_integer const& init, uint32_t max_pending) : big_accumulator() {
+    this->max_pending = std::min(max_pending, default_max_pending);
+    add(init, false);
+}
+
+big_accumulator& big_accumulator::operator+=(big_integer const& rhs) {
+    add(rhs, false);
+    return *this;
+}
+
+big_accumulator& big_accumulator::operator-=(big_integer const& rhs) {
+    add(rhs, true);
+    return *this;
+}
+
+// x = sum(number[i] * beta^i) - beta^n if it is negative
+void big_accumulator::add(big_integer const& x, bool subtract) {
+    if (pending >= max_pending) {
+        normalize();
+    }
+    size_t n = x.number.size();
+    if (lanes.size() < n + 1) {
+        lanes.resize(n + 1, 0);
+    }
+    uint32_t const* limbs = x.number.data();
+    uint64_t* lane = lanes.data();
+    if (subtract) {
+        for (size_t i = 0; i < n; i++) {
+            lane[i] -= limbs[i];
+        }
+        lane[n] += x.is_negative;
+    } else {
+        for (size_t i = 0; i < n; i++) {
+            lane[i] += limbs[i];
+        }
+        lane[n] -= x.is_negative;
+    }
+    pending++;
+}
+
+// every lane but the top one back below 2^32, the top one keeps the signed carry
+void big_accumulator::normalize() {
+    int64_t carry = 0;
+    size_t n = lanes.size();
+    for (size_t i = 0; i + 1 < n; i++) {
+        lanes[i] = split(lanes[i], carry);
+    }
+    lanes[n - 1] += static_cast<uint64_t>(carry);
+    pending = 0;
+}
+
+big_integer big_accumulator::value() const {
+    big_integer result;
+    result.number.resize(lanes.size());
+    int64_t carry = 0;
+    for (size_t i = 0; i < lanes.size(); i++) {
+        result.number[i] = split(lanes[i], carry);
+    }
+    while (carry != 0 && carry != -1) {
+        result.number.push_back(split(0, carry));
+    }
+    result.is_negative = carry == -1;
+    big_integer::min_length(result);
+    return result;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "big_integer.h"
+#include <cstdint>
+#include <vector>
+
+// A running sum of big_integers with carries left unresolved: every limb position keeps a
+// 64-bit lane, so += and -= are a single pass of independent additions without carry
+// propagation or min_length. Carries are resolved when value() is read, or in place
+// once enough additions have piled up to put the lanes at risk of overflowing.
+struct big_accumulator
+{
+    big_accumulator();
+    explicit big_accumulator(big_integer const& init);
+    // normalizes in place after every max_pending additions instead of 2^30, which is also the
+    // most it allows; small values exercise the normalization
+    big_accumulator(big_integer const& init, uint32_t max_pending);
+
+    big_accumulator& operator+=(big_integer const& rhs);
+    big_accumulator& operator-=(big_integer const& rhs);
+
+    big_integer value() const;
+
+private:
+    void add(big_integer const& x, bool subtract);
+    void normalize();
+
+    // lane i is a two's complement signed count of beta^i
+    std::vector<uint64_t> lanes;
+    uint32_t pending;
+    uint32_t max_pending;
+};
@@ -0,0 +1,395 @@
+#include "big_decimal_integer.h"
+#include <algorithm>
+#include <ostream>
+#include <stdexcept>
+
+namespace {
+    uint32_t static constexpr billion = 1'000'000'000;
+    size_t static constexpr digits = 9;
+    // below this many limbs the conversion to big_integer is a plain Horner scheme
+    size_t static constexpr join_threshold = 16;
+
+    void add_magnitude(std::vector<uint32_t>& a, std::vector<uint32_t> const& b) {
+        if (a.size() < b.size()) {
+            a.resize(b.size(), 0);
+        }
+        uint32_t carry = 0;
+        for (size_t i = 0; i < a.size() && (i < b.size() || carry != 0); i++) {
+            uint32_t sum = a[i] + (i < b.size() ? b[i] : 0) + carry;
+            carry = sum >= billion;
+            a[i] = carry != 0 ? sum - billion : sum;
+        }
+        if (carry != 0) {
+            a.push_back(carry);
+        }
+    }
+
+    // a -= b for a >= b
+    void sub_magnitude(std::vector<uint32_t>& a, std::vector<uint32_t> const& b) {
+        uint32_t borrow = 0;
+        for (size_t i = 0; i < a.size() && (i < b.size() || borrow != 0); i++) {
+            uint32_t sub = (i < b.size() ? b[i] : 0) + borrow;
+            borrow = a[i] < sub;
+            a[i] = borrow != 0 ? a[i] + billion - sub : a[i] - sub;
+        }
+    }
+
+    // a = a * m + add
+    void mul_add_1(std::vector<uint32_t>& a, uint32_t m, uint32_t add) {
+        uint64_t carry = add;
+        for (uint32_t& limb : a) {
+            carry += static_cast<uint64_t>(limb) * m;
+            limb = static_cast<uint32_t>(carry % billion);
+            carry /= billion;
+        }
+        if (carry != 0) {
+            a.push_back(static_cast<uint32_t>(carry));
+        }
+    }
+
+    uint32_t divmod_1(std::vector<uint32_t>& a, uint32_t d) {
+        uint64_t rest = 0;
+        for (size_t i = a.size(); i > 0; i--) {
+            rest = rest * billion + a[i - 1];
+            a[i - 1] = static_cast<uint32_t>(rest / d);
+            rest %= d;
+        }
+        return static_cast<uint32_t>(rest);
+    }
+
+    // limbs [0, n) of a; powers[k] = 10^(9 * 2^k) are added as the halves grow
+    big_integer join(uint32_t const* a, size_t n, std::vector<big_integer>& powers) {
+        if (n <= join_threshold) {
+            big_integer result;
+            for (size_t i = n; i > 0; i--) {
+                result *= billion;
+                result += a[i - 1];
+            }
+            return result;
+        }
+        size_t k = 0;
+        while ((size_t(2) << k) < n) {
+            k++;
+        }
+        while (powers.size() <= k) {
+            powers.push_back(powers.back() * powers.back());
+        }
+        size_t half = size_t(1) << k;
+        return join(a + half, n - half, powers) * powers[k] + join(a, half, powers);
+    }
+}
+
+big_decimal_integer::big_decimal_integer() : is_negative(false) {}
+
+big_decimal_integer::big_decimal_integer(unsigned long long a) : is_negative(false) {
+    fill_number(a);
+}
+
+big_decimal_integer::big_decimal_integer(long long a) : is_negative(a < 0) {
+    fill_number(a < 0 ? 0 - static_cast<unsigned long long>(a) : static_cast<unsigned long long>(a));
+}
+
+big_decimal_integer::big_decimal_integer(unsigned long a) : big_decimal_integer(static_cast<unsigned long long>(a)) {}
+big_decimal_integer::big_decimal_integer(long a) : big_decimal_integer(static_cast<long long>(a)) {}
+big_decimal_integer::big_decimal_integer(unsigned int a) : big_decimal_integer(static_cast<unsigned long long>(a)) {}
+big_decimal_integer::big_decimal_integer(int a) : big_decimal_integer(static_cast<long long>(a)) {}
+
+void big_decimal_integer::fill_number(unsigned long long a) {
+    for (; a != 0; a /= billion) {
+        number.push_back(static_cast<uint32_t>(a % billion));
+    }
+}
+
+big_decimal_integer::big_decimal_integer(std::string const& str) : is_negative(false) {
+    size_t start = str.size() > 1 && (str[0] == '-' || str[0] == '+') ? 1 : 0;
+    if (start == str.size()) {
+        throw std::invalid_argument(str);
+    }
+    for (size_t i = start; i < str.size(); i++) {
+        if (str[i] < '0' || str[i] > '9') {
+            throw std::invalid_argument(str);
+        }
+    }
+    number.reserve((str.size() - start + digits - 1) / digits);
+    for (size_t end = str.size(); end > start;) {
+        size_t first = end - std::min(digits, end - start);
+        uint32_t limb = 0;
+        for (size_t i = first; i < end; i++) {
+            limb = limb * 10 + static_cast<uint32_t>(str[i] - '0');
+        }
+        number.push_back(limb);
+        end = first;
+    }
+    is_negative = str[0] == '-';
+    trim();
+}
+
+big_decimal_integer::big_decimal_integer(big_integer const& a) : big_decimal_integer(to_string(a)) {}
+
+big_decimal_integer::operator big_integer() const {
+    if (number.empty()) {
+        return 0;
+    }
+    std::vector<big_integer> powers(1, billion);
+    big_integer result = join(number.data(), number.size(), powers);
+    return is_negative ? -result : result;
+}
+
+big_decimal_integer& big_decimal_integer::operator+=(big_decimal_integer const& rhs) {
+    add(rhs, false);
+    return *this;
+}
+
+big_decimal_integer& big_decimal_integer::operator-=(big_decimal_integer const& rhs) {
+    add(rhs, true);
+    return *this;
+}
+
+void big_decimal_integer::add(big_decimal_integer const& rhs, bool subtract) {
+    if (this == &rhs) {
+        big_decimal_integer copy(rhs);
+        add(copy, subtract);
+        return;
+    }
+    bool rhs_negative = rhs.is_negative != subtract;
+    if (is_negative == rhs_negative) {
+        add_magnitude(number, rhs.number);
+    } else if (compare_magnitude(number, rhs.number) >= 0) {
+        sub_magnitude(number, rhs.number);
+    } else {
+        std::vector<uint32_t> result = rhs.number;
+        sub_magnitude(result, number);
+        number.swap(result);
+        is_negative = rhs_negative;
+    }
+    trim();
+}
+
+// schoolbook, every row is carried through at once so the sums stay below 2^64
+big_decimal_integer& big_decimal_integer::operator*=(big_decimal_integer const& rhs) {
+    if (number.empty() || rhs.number.empty()) {
+        *this = big_decimal_integer();
+        return *this;
+    }
+    size_t na = number.size();
+    size_t nb = rhs.number.size();
+    std::vector<uint32_t> result(na + nb, 0);
+    for (size_t i = 0; i < na; i++) {
+        uint64_t carry = 0;
+        for (size_t j = 0; j < nb; j++) {
+            carry += static_cast<uint64_t>(number[i]) * rhs.number[j] + result[i + j];
+            result[i + j] = static_cast<uint32_t>(carry % billion);
+            carry /= billion;
+        }
+        result[i + nb] = static_cast<uint32_t>(carry);
+    }
+    number.swap(result);
+    is_negative = is_negative != rhs.is_negative;
+    trim();
+    return *this;
+}
+
+big_decimal_integer& big_decimal_integer::operator/=(big_decimal_integer const& rhs) {
+    divide(rhs, false);
+    return *this;
+}
+
+big_decimal_integer& big_decimal_integer::operator%=(big_decimal_integer const& rhs) {
+    divide(rhs, true);
+    return *this;
+}
+
+// truncating division of the magnitudes (Knuth's algorithm D in base 10^9), the signs are applied afterwards
+void big_decimal_integer::divide(big_decimal_integer const& rhs, bool remainder) {
+    if (rhs.number.empty()) {
+        throw std::invalid_argument("big_decimal_integer: division by zero");
+    }
+    bool negative_q = is_negative != rhs.is_negative;
+    std::vector<uint32_t> v = rhs.number;
+    size_t n = v.size();
+    std::vector<uint32_t> q;
+    std::vector<uint32_t> r;
+    if (compare_magnitude(number, v) < 0) {
+        r.swap(number);
+    } else if (n == 1) {
+        r.assign(1, divmod_1(number, v[0]));
+        q.swap(number);
+    } else {
+        auto d = billion / (v[n - 1] + 1);
+        std::vector<uint32_t> u = number;
+        mul_add_1(u, d, 0);
+        mul_add_1(v, d, 0);
+        u.resize(number.size() + 1, 0);
+        size_t m = u.size() - n - 1;
+        q.assign(m + 1, 0);
+        for (size_t j = m + 1; j > 0;) {
+            j--;
+            uint64_t current = static_cast<uint64_t>(u[j + n]) * billion + u[j + n - 1];
+            uint64_t qt = current / v[n - 1];
+            uint64_t rt = current % v[n - 1];
+            while (qt >= billion || qt * v[n - 2] > rt * billion + u[j + n - 2]) {
+                qt--;
+                rt += v[n - 1];
+                if (rt >= billion) {
+                    break;
+                }
+            }
+            uint64_t carry = 0;
+            int64_t borrow = 0;
+            for (size_t i = 0; i < n; i++) {
+                carry += qt * v[i];
+                int64_t res = static_cast<int64_t>(u[i + j]) - static_cast<int64_t>(carry % billion) - borrow;
+                carry /= billion;
+                borrow = res < 0;
+                u[i + j] = static_cast<uint32_t>(res < 0 ? res + billion : res);
+            }
+            int64_t top = static_cast<int64_t>(u[j + n]) - static_cast<int64_t>(carry) - borrow;
+            if (top < 0) {
+                qt--;
+                uint32_t add = 0;
+                for (size_t i = 0; i < n; i++) {
+                    uint32_t sum = u[i + j] + v[i] + add;
+                    add = sum >= billion;
+                    u[i + j] = add != 0 ? sum - billion : sum;
+                }
+                top += add;
+            }
+            u[j + n] = static_cast<uint32_t>(top);
+            q[j] = static_cast<uint32_t>(qt);
+        }
+        u.resize(n);
+        divmod_1(u, d);
+        r.swap(u);
+    }
+    if (remainder) {
+        number.swap(r);
+    } else {
+        number.swap(q);
+        is_negative = negative_q;
+    }
+    trim();
+}
+
+big_decimal_integer big_decimal_integer::operator+() const {
+    return *this;
+}
+
+big_decimal_integer big_decimal_integer::operator-() const {
+    big_decimal_integer result(*this);
+    result.is_negative = !is_negative;
+    result.trim();
+    return result;
+}
+
+big_decimal_integer& big_decimal_integer::operator++() {
+    return *this += 1;
+}
+
+big_decimal_integer big_decimal_integer::operator++(int) {
+    big_decimal_integer tmp(*this);
+    *this += 1;
+    return tmp;
+}
+
+big_decimal_integer& big_decimal_integer::operator--() {
+    return *this -= 1;
+}
+
+big_decimal_integer big_decimal_integer::operator--(int) {
+    big_decimal_integer tmp(*this);
+    *this -= 1;
+    return tmp;
+}
+
+void big_decimal_integer::trim() {
+    while (!number.empty() && number.back() == 0) {
+        number.pop_back();
+    }
+    if (number.empty()) {
+        is_negative = false;
+    }
+}
+
+int big_decimal_integer::compare_magnitude(std::vector<uint32_t> const& a, std::vector<uint32_t> const& b) {
+    if (a.size() != b.size()) {
+        return a.size() < b.size() ? -1 : 1;
+    }
+    for (size_t i = a.size(); i > 0; i--) {
+        if (a[i - 1] != b[i - 1]) {
+            return a[i - 1] < b[i - 1] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+big_decimal_integer operator+(big_decimal_integer a, big_decimal_integer const& b) {
+    return a += b;
+}
+
+big_decimal_integer operator-(big_decimal_integer a, big_decimal_integer const& b) {
+    return a -= b;
+}
+
+big_decimal_integer operator*(big_decimal_integer a, big_decimal_integer const& b) {
+    return a *= b;
+}
+
+big_decimal_integer operator/(big_decimal_integer a, big_decimal_integer const& b) {
+    return a /= b;
+}
+
+big_decimal_integer operator%(big_decimal_integer a, big_decimal_integer const& b) {
+    return a %= b;
+}
+
+bool operator==(big_decimal_integer const& a, big_decimal_integer const& b) {
+    return a.is_negative == b.is_negative && a.number == b.number;
+}
+
+bool operator!=(big_decimal_integer const& a, big_decimal_integer const& b) {
+    return !(a == b);
+}
+
+bool operator<(big_decimal_integer const& a, big_decimal_integer const& b) {
+    if (a.is_negative != b.is_negative) {
+        return a.is_negative;
+    }
+    int c = big_decimal_integer::compare_magnitude(a.number, b.number);
+    return a.is_negative ? c > 0 : c < 0;
+}
+
+bool operator>(big_decimal_integer const& a, big_decimal_integer const& b) {
+    return b < a;
+}
+
+bool operator<=(big_decimal_integer const& a, big_decimal_integer const& b) {
+    return !(b < a);
+}
+
+bool operator>=(big_decimal_integer const& a, big_decimal_integer const& b) {
+    return !(a < b);
+}
+
+std::string to_string(big_decimal_integer const& a) {
+    if (a.number.empty()) {
+        return "0";
+    }
+    std::string result = a.is_negative ? "-" : "";
+    result += std::to_string(a.number.back());
+    size_t start = result.size();
+    result.resize(start + (a.number.size() - 1) * digits);
+    char* out = &result[start];
+    for (size_t i = a.number.size() - 1; i > 0; i--) {
+        uint32_t limb = a.number[i - 1];
+        for (size_t k = digits; k > 0; k--) {
+            out[k - 1] = static_cast<char>('0' + limb % 10);
+            limb /= 10;
+        }
+        out += digits;
+    }
+    return result;
+}
+
+std::ostream& operator<<(std::ostream& s, big_decimal_integer const& a) {
+    return s << to_string(a);
+}
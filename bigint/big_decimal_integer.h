@@ -0,0 +1,79 @@
+#pragma once
+
+#include "big_integer.h"
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// Sign and magnitude in base 10^9 limbs, with the arithmetic operators of big_integer. Parsing and
+// to_string only regroup decimal digits, so they are linear; multiplication and division are
+// schoolbook, so heavy arithmetic should convert to big_integer and back explicitly.
+struct big_decimal_integer
+{
+    big_decimal_integer();
+    big_decimal_integer(unsigned long long a);
+    big_decimal_integer(long long a);
+    big_decimal_integer(unsigned long a);
+    big_decimal_integer(long a);
+    big_decimal_integer(unsigned int a);
+    big_decimal_integer(int a);
+    explicit big_decimal_integer(std::string const& str);
+    // through to_string of a, which is where the radix conversion happens
+    explicit big_decimal_integer(big_integer const& a);
+
+    // splits the limbs in halves and joins them with big_integer multiplications by powers of 10^9
+    explicit operator big_integer() const;
+
+    big_decimal_integer& operator+=(big_decimal_integer const& rhs);
+    big_decimal_integer& operator-=(big_decimal_integer const& rhs);
+    big_decimal_integer& operator*=(big_decimal_integer const& rhs);
+    // both throw std::invalid_argument for a zero rhs
+    big_decimal_integer& operator/=(big_decimal_integer const& rhs);
+    big_decimal_integer& operator%=(big_decimal_integer const& rhs);
+
+    big_decimal_integer operator+() const;
+    big_decimal_integer operator-() const;
+
+    big_decimal_integer& operator++();
+    big_decimal_integer operator++(int);
+
+    big_decimal_integer& operator--();
+    big_decimal_integer operator--(int);
+
+    friend bool operator==(big_decimal_integer const& a, big_decimal_integer const& b);
+    friend bool operator!=(big_decimal_integer const& a, big_decimal_integer const& b);
+    friend bool operator<(big_decimal_integer const& a, big_decimal_integer const& b);
+    friend bool operator>(big_decimal_integer const& a, big_decimal_integer const& b);
+    friend bool operator<=(big_decimal_integer const& a, big_decimal_integer const& b);
+    friend bool operator>=(big_decimal_integer const& a, big_decimal_integer const& b);
+
+    friend std::string to_string(big_decimal_integer const& a);
+
+private:
+    void fill_number(unsigned long long a);
+    void add(big_decimal_integer const& rhs, bool subtract);
+    void divide(big_decimal_integer const& rhs, bool remainder);
+    void trim();
+    static int compare_magnitude(std::vector<uint32_t> const& a, std::vector<uint32_t> const& b);
+
+    bool is_negative;
+    // little-endian base 10^9 limbs without leading zeros, empty for zero
+    std::vector<uint32_t> number;
+};
+
+big_decimal_integer operator+(big_decimal_integer a, big_decimal_integer const& b);
+big_decimal_integer operator-(big_decimal_integer a, big_decimal_integer const& b);
+big_decimal_integer operator*(big_decimal_integer a, big_decimal_integer const& b);
+big_decimal_integer operator/(big_decimal_integer a, big_decimal_integer const& b);
+big_decimal_integer operator%(big_decimal_integer a, big_decimal_integer const& b);
+
+bool operator==(big_decimal_integer const& a, big_decimal_integer const& b);
+bool operator!=(big_decimal_integer const& a, big_decimal_integer const& b);
+bool operator<(big_decimal_integer const& a, big_decimal_integer const& b);
+bool operator>(big_decimal_integer const& a, big_decimal_integer const& b);
+bool operator<=(big_decimal_integer const& a, big_decimal_integer const& b);
+bool operator>=(big_decimal_integer const& a, big_decimal_integer const& b);
+
+std::string to_string(big_decimal_integer const& a);
+std::ostream& operator<<(std::ostream& s, big_decimal_integer const& a);
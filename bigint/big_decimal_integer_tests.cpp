@@ -0,0 +1,107 @@
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <gtest/gtest.h>
+
+#include "big_decimal_integer.h"
+#include "big_integer.h"
+
+TEST(big_decimal_integer, basic)
+{
+    big_decimal_integer a = 2;
+    big_decimal_integer b = -3;
+
+    EXPECT_EQ(-1, a + b);
+    EXPECT_EQ(5, a - b);
+    EXPECT_EQ(-6, a * b);
+    EXPECT_EQ(0, a / b);
+    EXPECT_EQ(-1, b / a);
+    EXPECT_EQ(-1, b % a);
+    EXPECT_EQ(3, -b);
+    EXPECT_TRUE(b < a);
+    EXPECT_EQ(-2, ++b);
+    EXPECT_EQ(-2, b--);
+    EXPECT_EQ(-3, b);
+    EXPECT_EQ("-3", to_string(b));
+    EXPECT_EQ("0", to_string(big_decimal_integer()));
+    EXPECT_EQ(big_decimal_integer(), big_decimal_integer("-0"));
+    EXPECT_EQ(big_decimal_integer(), a - a);
+
+    std::stringstream s;
+    s << big_decimal_integer(-1000000000LL);
+    EXPECT_EQ("-1000000000", s.str());
+}
+
+TEST(big_decimal_integer, strings)
+{
+    std::string digits = "123456789012345678901234567890123456789000000000000000000000000000000000001";
+    EXPECT_EQ(digits, to_string(big_decimal_integer(digits)));
+    EXPECT_EQ("-" + digits, to_string(big_decimal_integer("-" + digits)));
+    EXPECT_EQ(digits, to_string(big_decimal_integer("+000000000000" + digits)));
+    EXPECT_EQ("18446744073709551615", to_string(big_decimal_integer(18446744073709551615ULL)));
+    EXPECT_EQ("-9223372036854775808", to_string(big_decimal_integer(std::numeric_limits<long long>::min())));
+
+    EXPECT_THROW(big_decimal_integer(""), std::invalid_argument);
+    EXPECT_THROW(big_decimal_integer("-"), std::invalid_argument);
+    EXPECT_THROW(big_decimal_integer("+"), std::invalid_argument);
+    EXPECT_THROW(big_decimal_integer("12a3"), std::invalid_argument);
+}
+
+TEST(big_decimal_integer, matches_big_integer)
+{
+    std::mt19937_64 rng(44);
+    for (int i = 0; i != 2000; ++i)
+    {
+        big_integer x = big_integer::random_bits(rng() % 2000 + 1, rng);
+        big_integer y = big_integer::random_bits(rng() % 1200 + 1, rng) + 1;
+        if (rng() % 2 == 0)
+            x = -x;
+        if (rng() % 2 == 0)
+            y = -y;
+        big_decimal_integer a(x);
+        big_decimal_integer b(y);
+
+        EXPECT_EQ(to_string(x), to_string(a));
+        EXPECT_EQ(x, big_integer(a));
+        EXPECT_EQ(to_string(x + y), to_string(a + b));
+        EXPECT_EQ(to_string(x - y), to_string(a - b));
+        EXPECT_EQ(to_string(x * y), to_string(a * b));
+        EXPECT_EQ(to_string(x / y), to_string(a / b));
+        EXPECT_EQ(to_string(x % y), to_string(a % b));
+        EXPECT_EQ(x < y, a < b);
+        EXPECT_EQ(x == y, a == b);
+    }
+}
+
+TEST(big_decimal_integer, division_corrections)
+{
+    // divisors whose top limb is small or close to 10^9 and dividends made of 999999999 limbs
+    // take the quotient estimate through its correction steps
+    std::string nines(90, '9');
+    for (std::string divisor : {"1000000000000000001", "999999999999999999999999999", "1000000000999999999",
+                                "500000000000000000000000000", "999999999000000000"})
+    {
+        big_decimal_integer a(nines);
+        big_decimal_integer b(divisor);
+        big_integer x(nines);
+        big_integer y(divisor);
+        EXPECT_EQ(to_string(x / y), to_string(a / b));
+        EXPECT_EQ(to_string(x % y), to_string(a % b));
+        EXPECT_EQ(a, a / b * b + a % b);
+    }
+    big_decimal_integer a("123456789123456789123456789");
+    EXPECT_EQ(1, a / a);
+    EXPECT_EQ(0, a % a);
+    a *= a;
+    EXPECT_EQ("15241578780673678546105778281054720515622620750190521", to_string(a));
+
+    big_decimal_integer zero;
+    EXPECT_THROW(a / zero, std::invalid_argument);
+    EXPECT_THROW(a % zero, std::invalid_argument);
+    EXPECT_THROW(big_decimal_integer(-7) / zero, std::invalid_argument);
+    EXPECT_THROW(zero / zero, std::invalid_argument);
+    EXPECT_THROW(zero % big_decimal_integer("-0"), std::invalid_argument);
+    EXPECT_THROW(a /= zero, std::invalid_argument);
+    EXPECT_EQ("15241578780673678546105778281054720515622620750190521", to_string(a));
+}
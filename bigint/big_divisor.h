@@ -0,0 +1,42 @@
+#pragma once
+
+#include "big_integer.h"
+#include <utility>
+
+// A divisor prepared once for many divisions. The constructor normalizes the magnitude, computes
+// the reciprocal used for quotient limbs and, for long divisors, the Barrett constant,
+// so a / d and a % d only do the division itself.
+struct big_divisor
+{
+    // throws std::invalid_argument for a zero divisor
+    explicit big_divisor(big_integer const& d);
+
+    big_integer const& value() const;
+
+    friend big_integer operator/(big_integer const& a, big_divisor const& d);
+    friend big_integer operator%(big_integer const& a, big_divisor const& d);
+    friend big_integer& operator/=(big_integer& a, big_divisor const& d);
+    friend big_integer& operator%=(big_integer& a, big_divisor const& d);
+    friend std::pair<big_integer, big_integer> divmod(big_integer const& a, big_divisor const& d);
+
+private:
+    friend struct big_workspace;
+
+    void divide_to(big_integer* q, big_integer* r, big_integer const& a) const;
+    void divide_to(big_integer* q, big_integer* r, big_integer const& a, big_integer::limb_vector& u,
+                   big_integer::limb_vector& quotient, big_integer::limb_vector& buffer) const;
+    void barrett_divide(uint32_t* q, uint32_t* u, size_t nu, big_integer::limb_vector& buffer) const;
+
+    big_integer divisor;
+    unsigned shift;
+    big_integer::limb_vector normalized;
+    uint32_t inverse;
+    // floor(beta^(2n) / normalized) for n limbs, empty below the Barrett threshold
+    big_integer::limb_vector barrett;
+};
+
+big_integer operator/(big_integer const& a, big_divisor const& d);
+big_integer operator%(big_integer const& a, big_divisor const& d);
+big_integer& operator/=(big_integer& a, big_divisor const& d);
+big_integer& operator%=(big_integer& a, big_divisor const& d);
+std::pair<big_integer, big_integer> divmod(big_integer const& a, big_divisor const& d);
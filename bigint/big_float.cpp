@@ -0,0 +1,367 @@
+#include "big_float.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+constexpr size_t big_float::default_precision;
+
+namespace {
+    // below this many quotient or divisor bits big_integer division beats the Newton reciprocal,
+    // whose multiplications only pull ahead once they are well into the Karatsuba range
+    size_t static constexpr newton_threshold = 131072;
+
+    long signed_bits(big_integer const& a) {
+        return static_cast<long>(bit_length(a));
+    }
+
+    // approximately 2^(bits(d) + m) / d from the top m + 3 bits of d: each Newton step
+    // x + x * (1 - d * x) doubles the number of correct bits of the one half as long
+    big_integer reciprocal(big_integer const& d, long m) {
+        long bd = signed_bits(d);
+        long bt = std::min(bd, m + 3);
+        big_integer top = d >> static_cast<int>(bd - bt);
+        if (m <= 64) {
+            return (big_integer(1) << static_cast<int>(bt + m)) / top;
+        }
+        long h = m / 2 + 2;
+        big_integer x = reciprocal(d, h);
+        big_integer error = (big_integer(1) << static_cast<int>(bt + h)) - top * x;
+        return (x << static_cast<int>(m - h)) + ((x * error) >> static_cast<int>(bt + 2 * h - m));
+    }
+
+    // {floor(n / d), n mod d} for n >= 0 and d > 0; the estimate from the reciprocal
+    // is off by a few units at most, the remainder puts it right
+    std::pair<big_integer, big_integer> divide(big_integer const& n, big_integer const& d) {
+        long bn = signed_bits(n);
+        long bd = signed_bits(d);
+        if (bn - bd < static_cast<long>(newton_threshold) || bd < static_cast<long>(newton_threshold)) {
+            return divmod(n, d);
+        }
+        long m = bn - bd + 5;
+        big_integer q = (n * reciprocal(d, m)) >> static_cast<int>(bd + m);
+        big_integer r = n - q * d;
+        while (r < 0) {
+            --q;
+            r += d;
+        }
+        while (r >= d) {
+            ++q;
+            r -= d;
+        }
+        return {q, r};
+    }
+
+    // floor(sqrt(n)) for n >= 0: the root of the top half of n, scaled back and taken through
+    // one Newton step s = (s + n / s) / 2, which doubles its correct bits
+    big_integer isqrt(big_integer const& n) {
+        long bn = signed_bits(n);
+        big_integer s;
+        if (bn <= 52) {
+            s = big_integer(std::sqrt(to_double(n)));
+        } else {
+            long h = bn / 4;
+            s = (isqrt(n >> static_cast<int>(2 * h)) + 1) << static_cast<int>(h);
+            s = (s + divide(n, s).first) >> 1;
+        }
+        while (s * s > n) {
+            --s;
+        }
+        while ((s + 1) * (s + 1) <= n) {
+            ++s;
+        }
+        return s;
+    }
+
+    big_integer power_of_ten(size_t k) {
+        big_integer result = 1;
+        big_integer square = 10;
+        for (; k != 0; k >>= 1) {
+            if ((k & 1) != 0) {
+                result *= square;
+            }
+            square *= square;
+        }
+        return result;
+    }
+}
+
+big_float::big_float() :
+    mantissa_(0),
+    exponent_(0),
+    precision_(default_precision) {}
+
+big_float::big_float(big_integer const& a, size_t precision, rounding mode) :
+    big_float(round(a, 0, precision, mode)) {}
+
+big_float::big_float(double a, size_t precision) : big_float() {
+    if (!std::isfinite(a)) {
+        throw std::invalid_argument("big_float: " + std::to_string(a));
+    }
+    int exponent;
+    double fraction = std::frexp(a, &exponent);
+    int digits = std::numeric_limits<double>::digits;
+    *this = round(big_integer(std::ldexp(fraction, digits)), exponent - digits, precision, rounding::to_nearest);
+}
+
+// the value mantissa * 2^exponent, which with inexact lies a little further from zero,
+// rounded to precision bits
+big_float big_float::round(big_integer mantissa, long exponent, size_t precision, rounding mode, bool inexact) {
+    big_float result;
+    result.precision_ = precision;
+    bool negative = mantissa < 0;
+    if (negative) {
+        mantissa.abs();
+    }
+    size_t bits = bit_length(mantissa);
+    if (bits == 0) {
+        return result;
+    }
+    size_t shift = bits > precision ? bits - precision : 0;
+    if (shift > 0 || inexact) {
+        big_integer q = mantissa >> static_cast<int>(shift);
+        big_integer rest = mantissa - (q << static_cast<int>(shift));
+        bool up = false;
+        if (rest != 0 || inexact) {
+            switch (mode) {
+            case rounding::to_nearest:
+                if (shift > 0) {
+                    big_integer half = big_integer(1) << static_cast<int>(shift - 1);
+                    up = rest > half || (rest == half && (inexact || (q & 1) != 0));
+                }
+                break;
+            case rounding::toward_zero:
+                break;
+            case rounding::upward:
+                up = !negative;
+                break;
+            case rounding::downward:
+                up = negative;
+                break;
+            }
+        }
+        mantissa = up ? q + 1 : q;
+        exponent += static_cast<long>(shift);
+        if (bit_length(mantissa) > precision) {
+            mantissa >>= 1;
+            exponent++;
+        }
+    }
+    result.mantissa_ = negative ? -mantissa : mantissa;
+    result.exponent_ = exponent;
+    return result;
+}
+
+big_float::operator big_integer() const {
+    if (exponent_ >= 0) {
+        return mantissa_ << static_cast<int>(exponent_);
+    }
+    big_integer magnitude = mantissa_;
+    magnitude.abs();
+    magnitude >>= static_cast<int>(std::min(-exponent_, signed_bits(magnitude)));
+    return mantissa_ < 0 ? -magnitude : magnitude;
+}
+
+size_t big_float::precision() const {
+    return precision_;
+}
+
+big_integer const& big_float::mantissa() const {
+    return mantissa_;
+}
+
+long big_float::exponent() const {
+    return exponent_;
+}
+
+big_float& big_float::operator+=(big_float const& rhs) {
+    return *this = add(*this, rhs, std::max(precision_, rhs.precision_), rounding::to_nearest);
+}
+
+big_float& big_float::operator-=(big_float const& rhs) {
+    return *this = sub(*this, rhs, std::max(precision_, rhs.precision_), rounding::to_nearest);
+}
+
+big_float& big_float::operator*=(big_float const& rhs) {
+    return *this = mul(*this, rhs, std::max(precision_, rhs.precision_), rounding::to_nearest);
+}
+
+big_float& big_float::operator/=(big_float const& rhs) {
+    return *this = div(*this, rhs, std::max(precision_, rhs.precision_), rounding::to_nearest);
+}
+
+big_float big_float::operator+() const {
+    return *this;
+}
+
+big_float big_float::operator-() const {
+    big_float result(*this);
+    result.mantissa_ = -mantissa_;
+    return result;
+}
+
+// When b lies entirely below the lowest of the precision + 3 leading bits of a, only its sign
+// matters for rounding, so it is replaced by one unit of that lowest bit instead of aligning
+// the mantissas across the whole exponent gap
+big_float add(big_float const& a, big_float const& b, size_t precision, rounding mode) {
+    if (a.mantissa_ == 0 || b.mantissa_ == 0) {
+        big_float const& x = a.mantissa_ == 0 ? b : a;
+        return big_float::round(x.mantissa_, x.exponent_, precision, mode);
+    }
+    long ta = a.exponent_ + signed_bits(a.mantissa_);
+    long tb = b.exponent_ + signed_bits(b.mantissa_);
+    big_float const& x = ta >= tb ? a : b;
+    big_float const& y = ta >= tb ? b : a;
+    long bx = signed_bits(x.mantissa_);
+    long guard = std::max(static_cast<long>(precision) + 2, bx) + 1 - bx;
+    long unit = x.exponent_ - guard;
+    if (std::min(ta, tb) <= unit) {
+        big_integer m = x.mantissa_ << static_cast<int>(guard);
+        m += y.mantissa_ < 0 ? -1 : 1;
+        return big_float::round(m, unit, precision, mode);
+    }
+    long e = std::min(x.exponent_, y.exponent_);
+    big_integer m = (x.mantissa_ << static_cast<int>(x.exponent_ - e)) +
+                    (y.mantissa_ << static_cast<int>(y.exponent_ - e));
+    return big_float::round(m, e, precision, mode);
+}
+
+big_float sub(big_float const& a, big_float const& b, size_t precision, rounding mode) {
+    return add(a, -b, precision, mode);
+}
+
+big_float mul(big_float const& a, big_float const& b, size_t precision, rounding mode) {
+    return big_float::round(a.mantissa_ * b.mantissa_, a.exponent_ + b.exponent_, precision, mode);
+}
+
+// the quotient of the mantissas scaled to at least precision + 2 bits, the remainder decides
+// whether the exact result lies past it
+big_float div(big_float const& a, big_float const& b, size_t precision, rounding mode) {
+    if (b.mantissa_ == 0) {
+        throw std::invalid_argument("big_float: division by zero");
+    }
+    if (a.mantissa_ == 0) {
+        return big_float::round(0, 0, precision, mode);
+    }
+    big_integer n = a.mantissa_;
+    big_integer d = b.mantissa_;
+    n.abs();
+    d.abs();
+    long k = static_cast<long>(precision) + 2 + signed_bits(d) - signed_bits(n);
+    if (k > 0) {
+        n <<= static_cast<int>(k);
+    } else {
+        d <<= static_cast<int>(-k);
+    }
+    std::pair<big_integer, big_integer> qr = divide(n, d);
+    bool negative = (a.mantissa_ < 0) != (b.mantissa_ < 0);
+    return big_float::round(negative ? -qr.first : qr.first, a.exponent_ - b.exponent_ - k, precision, mode,
+                            qr.second != 0);
+}
+
+big_float sqrt(big_float const& a, size_t precision, rounding mode) {
+    if (a.mantissa_ < 0) {
+        throw std::invalid_argument("sqrt: negative value");
+    }
+    if (a.mantissa_ == 0) {
+        return big_float::round(0, 0, precision, mode);
+    }
+    long k = std::max(2 * (static_cast<long>(precision) + 2) - signed_bits(a.mantissa_), 0L);
+    if ((a.exponent_ - k) % 2 != 0) {
+        k++;
+    }
+    big_integer n = a.mantissa_ << static_cast<int>(k);
+    big_integer s = isqrt(n);
+    return big_float::round(s, (a.exponent_ - k) / 2, precision, mode, s * s != n);
+}
+
+big_float ldexp(big_float a, long exponent) {
+    a.exponent_ += exponent;
+    return a;
+}
+
+big_float operator+(big_float a, big_float const& b) {
+    return a += b;
+}
+
+big_float operator-(big_float a, big_float const& b) {
+    return a -= b;
+}
+
+big_float operator*(big_float a, big_float const& b) {
+    return a *= b;
+}
+
+big_float operator/(big_float a, big_float const& b) {
+    return a /= b;
+}
+
+// the leading bit positions decide unless they are equal, and then the exponents
+// differ by less than the mantissa lengths, so aligning them is cheap
+int compare(big_float const& a, big_float const& b) {
+    int sa = a.mantissa_ < 0 ? -1 : a.mantissa_ != 0;
+    int sb = b.mantissa_ < 0 ? -1 : b.mantissa_ != 0;
+    if (sa != sb) {
+        return sa < sb ? -1 : 1;
+    }
+    if (sa == 0) {
+        return 0;
+    }
+    long ta = a.exponent_ + signed_bits(a.mantissa_);
+    long tb = b.exponent_ + signed_bits(b.mantissa_);
+    if (ta != tb) {
+        return ta < tb ? -sa : sa;
+    }
+    long e = std::min(a.exponent_, b.exponent_);
+    big_integer x = a.mantissa_ << static_cast<int>(a.exponent_ - e);
+    big_integer y = b.mantissa_ << static_cast<int>(b.exponent_ - e);
+    return x < y ? -1 : x != y;
+}
+
+bool operator==(big_float const& a, big_float const& b) {
+    return compare(a, b) == 0;
+}
+
+bool operator!=(big_float const& a, big_float const& b) {
+    return compare(a, b) != 0;
+}
+
+bool operator<(big_float const& a, big_float const& b) {
+    return compare(a, b) < 0;
+}
+
+bool operator>(big_float const& a, big_float const& b) {
+    return compare(a, b) > 0;
+}
+
+bool operator<=(big_float const& a, big_float const& b) {
+    return compare(a, b) <= 0;
+}
+
+bool operator>=(big_float const& a, big_float const& b) {
+    return compare(a, b) >= 0;
+}
+
+double to_double(big_float const& a) {
+    big_float r = big_float::round(a.mantissa_, a.exponent_, std::numeric_limits<double>::digits, rounding::to_nearest);
+    long e = std::max(std::min(r.exponent(), static_cast<long>(std::numeric_limits<int>::max())),
+                      static_cast<long>(std::numeric_limits<int>::min()));
+    return std::ldexp(to_double(r.mantissa()), static_cast<int>(e));
+}
+
+std::string to_string(big_float const& a, size_t fraction_digits) {
+    big_integer scale = power_of_ten(fraction_digits);
+    size_t bits = bit_length(scale);
+    big_integer scaled(mul(a, big_float(scale, bits), bit_length(a.mantissa()) + bits, rounding::toward_zero));
+    bool negative = a.mantissa() < 0;
+    scaled.abs();
+    std::string digits = to_string(scaled);
+    if (digits.size() <= fraction_digits) {
+        digits.insert(0, fraction_digits + 1 - digits.size(), '0');
+    }
+    if (fraction_digits > 0) {
+        digits.insert(digits.size() - fraction_digits, 1, '.');
+    }
+    return negative ? "-" + digits : digits;
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "big_integer.h"
+#include <cstddef>
+#include <string>
+#include <type_traits>
+
+enum class rounding
+{
+    to_nearest,
+    toward_zero,
+    upward,
+    downward
+};
+
+// Binary floating point number mantissa * 2^exponent with |mantissa| < 2^precision. Every
+// operation is correctly rounded: the exact result is rounded to the requested precision in the
+// requested mode. The operators round to nearest, ties to even, at the larger precision of the
+// operands. Products go through big_integer multiplication; quotients and square roots of long
+// mantissas through Newton iterations built on it.
+struct big_float
+{
+    static constexpr size_t default_precision = 128;
+
+    big_float();
+    big_float(big_integer const& a, size_t precision = default_precision, rounding mode = rounding::to_nearest);
+
+    template <typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+    big_float(T a, size_t precision = default_precision) : big_float(big_integer(a), precision) {}
+
+    // exact for precision >= 53, std::invalid_argument for infinities and NaN
+    explicit big_float(double a, size_t precision = default_precision);
+
+    // toward zero
+    explicit operator big_integer() const;
+
+    size_t precision() const;
+    big_integer const& mantissa() const;
+    long exponent() const;
+
+    big_float& operator+=(big_float const& rhs);
+    big_float& operator-=(big_float const& rhs);
+    big_float& operator*=(big_float const& rhs);
+    big_float& operator/=(big_float const& rhs);
+
+    big_float operator+() const;
+    big_float operator-() const;
+
+    friend big_float add(big_float const& a, big_float const& b, size_t precision, rounding mode);
+    friend big_float sub(big_float const& a, big_float const& b, size_t precision, rounding mode);
+    friend big_float mul(big_float const& a, big_float const& b, size_t precision, rounding mode);
+    friend big_float div(big_float const& a, big_float const& b, size_t precision, rounding mode);
+    friend big_float sqrt(big_float const& a, size_t precision, rounding mode);
+    friend big_float ldexp(big_float a, long exponent);
+
+    friend int compare(big_float const& a, big_float const& b);
+    friend double to_double(big_float const& a);
+
+private:
+    static big_float round(big_integer mantissa, long exponent, size_t precision, rounding mode,
+                           bool inexact = false);
+
+    big_integer mantissa_;
+    long exponent_;
+    size_t precision_;
+};
+
+big_float add(big_float const& a, big_float const& b, size_t precision, rounding mode = rounding::to_nearest);
+big_float sub(big_float const& a, big_float const& b, size_t precision, rounding mode = rounding::to_nearest);
+big_float mul(big_float const& a, big_float const& b, size_t precision, rounding mode = rounding::to_nearest);
+// std::invalid_argument for a zero divisor
+big_float div(big_float const& a, big_float const& b, size_t precision, rounding mode = rounding::to_nearest);
+// std::invalid_argument for a negative a
+big_float sqrt(big_float const& a, size_t precision, rounding mode = rounding::to_nearest);
+// a * 2^exponent, exact
+big_float ldexp(big_float a, long exponent);
+
+big_float operator+(big_float a, big_float const& b);
+big_float operator-(big_float a, big_float const& b);
+big_float operator*(big_float a, big_float const& b);
+big_float operator/(big_float a, big_float const& b);
+
+// -1, 0 or 1 as a is less than, equal to or greater than b, whatever their precisions
+int compare(big_float const& a, big_float const& b);
+bool operator==(big_float const& a, big_float const& b);
+bool operator!=(big_float const& a, big_float const& b);
+bool operator<(big_float const& a, big_float const& b);
+bool operator>(big_float const& a, big_float const& b);
+bool operator<=(big_float const& a, big_float const& b);
+bool operator>=(big_float const& a, big_float const& b);
+
+// nearest, ties to even
+double to_double(big_float const& a);
+// a with the given number of digits after the decimal point, truncated toward zero
+std::string to_string(big_float const& a, size_t fraction_digits);
@@ -0,0 +1,156 @@
+#include <cmath>
+#include <limits>
+#include <random>
+#include <string>
+#include <gtest/gtest.h>
+
+#include "big_float.h"
+#include "big_integer.h"
+
+namespace
+{
+    double random_double(std::mt19937_64& rng)
+    {
+        std::uniform_real_distribution<double> fraction(0.5, 1);
+        double x = std::ldexp(fraction(rng), static_cast<int>(rng() % 200) - 100);
+        return rng() % 2 == 0 ? x : -x;
+    }
+
+    // one unit in the last place of a at its precision
+    big_float ulp(big_float const& a)
+    {
+        return ldexp(big_float(1), a.exponent() + static_cast<long>(bit_length(a.mantissa())) -
+                                       static_cast<long>(a.precision()));
+    }
+
+    big_float exact_mul(big_float const& a, big_float const& b)
+    {
+        return mul(a, b, bit_length(a.mantissa()) + bit_length(b.mantissa()) + 1);
+    }
+}
+
+TEST(big_float, basic)
+{
+    big_float a = 3;
+    big_float b = -4;
+    EXPECT_EQ(-1, a + b);
+    EXPECT_EQ(7, a - b);
+    EXPECT_EQ(-12, a * b);
+    EXPECT_EQ(big_float(-0.75), a / b);
+    EXPECT_EQ(4, -b);
+    EXPECT_TRUE(b < a);
+    EXPECT_TRUE(big_float(0.5) > big_float());
+    EXPECT_EQ(big_float(1, 10), big_float(1, 1000));
+    EXPECT_EQ(ldexp(big_float(3), -2), big_float(0.75));
+    EXPECT_EQ(big_float::default_precision, (a / b).precision());
+    EXPECT_EQ(1000u, (big_float(1, 1000) + a).precision());
+
+    EXPECT_EQ(big_integer(2), big_integer(big_float(2.99)));
+    EXPECT_EQ(big_integer(-2), big_integer(big_float(-2.99)));
+    EXPECT_EQ(big_integer(0), big_integer(big_float(-0.5)));
+    EXPECT_EQ(big_integer(1) << 200, big_integer(ldexp(big_float(1), 200)));
+
+    EXPECT_EQ("-0.750", to_string(big_float(-0.75), 3));
+    EXPECT_EQ("12", to_string(big_float(12.5), 0));
+    EXPECT_EQ("0.0625", to_string(big_float(0.0625), 4));
+    EXPECT_EQ("0.06", to_string(big_float(0.0625), 2));
+    EXPECT_EQ(0.1, to_double(big_float(0.1)));
+
+    EXPECT_THROW(a / big_float(), std::invalid_argument);
+    EXPECT_THROW(sqrt(b, 10), std::invalid_argument);
+    EXPECT_THROW(big_float(std::numeric_limits<double>::infinity()), std::invalid_argument);
+}
+
+TEST(big_float, rounding_modes)
+{
+    big_float third_down = div(1, 3, 10, rounding::downward);
+    big_float third_up = div(1, 3, 10, rounding::upward);
+    EXPECT_EQ(ldexp(big_float(0x2AA), -11), third_down);
+    EXPECT_EQ(ldexp(big_float(0x2AB), -11), third_up);
+    EXPECT_EQ(third_up, div(1, 3, 10, rounding::to_nearest));
+    EXPECT_EQ(third_down, div(1, 3, 10, rounding::toward_zero));
+    EXPECT_EQ(-third_up, div(-1, 3, 10, rounding::downward));
+    EXPECT_EQ(-third_down, div(-1, 3, 10, rounding::toward_zero));
+
+    // halfway cases go to the even mantissa
+    EXPECT_EQ(big_float(1024), add(big_float(1023), big_float(0.5), 10, rounding::to_nearest));
+    EXPECT_EQ(big_float(1022), add(big_float(1021), big_float(0.5), 10, rounding::to_nearest));
+    EXPECT_EQ(big_float(1021), add(big_float(1021), big_float(0.5), 10, rounding::downward));
+    EXPECT_EQ(big_float(1023), add(big_float(1022), big_float(0.5), 10, rounding::upward));
+
+    // a term far below the precision only moves the directed roundings
+    big_float tiny = ldexp(big_float(1), -100000);
+    EXPECT_EQ(big_float(1), add(big_float(1), tiny, 20, rounding::to_nearest));
+    EXPECT_EQ(big_float(1), add(big_float(1), tiny, 20, rounding::downward));
+    EXPECT_EQ(big_float(1) + ldexp(big_float(1), -19), add(big_float(1), tiny, 20, rounding::upward));
+    EXPECT_EQ(big_float(1) - ldexp(big_float(1), -20), sub(big_float(1), tiny, 20, rounding::downward));
+    EXPECT_EQ(big_float(1), sub(big_float(1), tiny, 20, rounding::upward));
+}
+
+TEST(big_float, matches_double)
+{
+    // with 53 bits and rounding to nearest every operation is the IEEE double one
+    std::mt19937_64 rng(47);
+    for (int i = 0; i != 10000; ++i)
+    {
+        double x = random_double(rng);
+        double y = random_double(rng);
+        big_float a(x, 53);
+        big_float b(y, 53);
+        EXPECT_EQ(x + y, to_double(a + b));
+        EXPECT_EQ(x - y, to_double(a - b));
+        EXPECT_EQ(x * y, to_double(a * b));
+        EXPECT_EQ(x / y, to_double(a / b));
+        EXPECT_EQ(std::sqrt(std::fabs(x)), to_double(sqrt(big_float(std::fabs(x), 53), 53)));
+
+        big_float down = div(a, b, 53, rounding::downward);
+        big_float up = div(a, b, 53, rounding::upward);
+        EXPECT_TRUE(down == up || std::nextafter(to_double(down), 1e300) == to_double(up));
+    }
+}
+
+TEST(big_float, constants)
+{
+    std::string sqrt2 = "1.41421356237309504880168872420969807856967187537694807317667973799073247846210703885038753432764157"
+                        "2735013846230912297024924836055850737212644121497099935831413222665927505592755799950501152782060571"
+                        "4701095599716059702745345968620147285174186408891986095523292304843087143214508397626036279952514079"
+                        "8968725339654633180882964062061525835239505474575028775996172983557522033753185701135437460340849884"
+                        "7160386899970699004815030544027790316454247823068492936918621580578463111596668713013015618568987237"
+                        "2352885092648612494977154218334204285686060146824720771435854874155657069677653720226485447015858801"
+                        "6207584749226572260020855844665214583988939443709265918003113882464681570826301005948587040031864803"
+                        "4219489727829064104507263688131373985525611732204024509122770022694112757362728049573810896750401836"
+                        "9868368450725799364729060762996941380475654823728997180326802474420629269124859052181004459842150591"
+                        "1202494413417285314781058036033710773091828693147101711116839165817268894197587165821521282295184884"
+                        "72";
+    EXPECT_EQ(sqrt2, to_string(sqrt(big_float(2), 3400), 1000));
+
+    std::string seventh = "0.";
+    for (int i = 0; i != 100; ++i)
+        seventh += "142857";
+    EXPECT_EQ(seventh, to_string(div(1, 7, 2000), 600));
+}
+
+TEST(big_float, long_mantissas)
+{
+    // the longest quotients and roots go through the Newton reciprocal
+    std::mt19937_64 rng(48);
+    for (size_t precision : {3000u, 20000u, 140000u})
+    {
+        for (int i = 0; i != (precision > 100000 ? 2 : 5); ++i)
+        {
+            big_float a(big_integer::random_bits(precision, rng) + 1, precision);
+            big_float b(big_integer::random_bits(precision / 2 + rng() % precision, rng) + 1, precision);
+            a = ldexp(a, static_cast<long>(rng() % 1000) - 500);
+
+            big_float q = div(a, b, precision, rounding::toward_zero);
+            EXPECT_LE(exact_mul(q, b), a);
+            EXPECT_GT(exact_mul(q + ulp(q), b), a);
+            EXPECT_EQ(q, div(exact_mul(q, b), b, precision, rounding::toward_zero));
+
+            big_float s = sqrt(a, precision, rounding::toward_zero);
+            EXPECT_LE(exact_mul(s, s), a);
+            big_float next = add(s, ulp(s), precision + 1, rounding::to_nearest);
+            EXPECT_GT(exact_mul(next, next), a);
+        }
+    }
+}
@@ -1,21 +1,297 @@
 #include "big_integer.h"
+#include "big_divisor.h"
+#include "big_integer_internal.h"
+#include "big_integer_kernels.h"
+#include "big_integer_thresholds.h"
+#include "big_workspace.h"
+#include "mod_context.h"
 #include <algorithm>
+#include <cmath>
 #include <cstddef>
 #include <functional>
+#include <future>
+#include <limits>
 #include <ostream>
 #include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
 
 uint16_t static constexpr block = 32;
 uint64_t static constexpr base = 1LL << block;
 size_t static constexpr len = 9;
 uint32_t static constexpr billion = 1'000'000'000;
+#ifdef BIG_INTEGER_TUNE
+size_t karatsuba_threshold = KARATSUBA_THRESHOLD;
+size_t barrett_threshold = BARRETT_THRESHOLD;
+#else
+size_t static constexpr karatsuba_threshold = KARATSUBA_THRESHOLD;
+size_t static constexpr barrett_threshold = BARRETT_THRESHOLD;
+#endif
 big_integer static const zero = 0;
 
+using big_integer_detail::count;
+using big_integer_detail::counter;
+
+uint32_t limbs_add(uint32_t* r, size_t n, uint32_t const* a, size_t m) {
+    uint64_t carry = kernels.add_n(r, r, a, m);
+    for (size_t i = m; i < n && carry != 0; i++) {
+        carry += r[i];
+        r[i] = static_cast<uint32_t>(carry);
+        carry >>= block;
+    }
+    return static_cast<uint32_t>(carry);
+}
+
+uint32_t limbs_sub(uint32_t* r, size_t n, uint32_t const* a, size_t m) {
+    uint32_t borrow = kernels.sub_n(r, r, a, m);
+    for (size_t i = m; i < n && borrow != 0; i++) {
+        borrow = r[i] == 0;
+        r[i]--;
+    }
+    return borrow;
+}
+
+void limbs_mul_basecase(uint32_t* r, uint32_t const* a, size_t na, uint32_t const* b, size_t nb) {
+    r[na] = kernels.mul_1(r, a, na, b[0]);
+    for (size_t i = 1; i < nb; i++) {
+        r[i + na] = kernels.addmul_1(r + i, a, na, b[i]);
+    }
+}
+
+size_t limbs_mul_scratch(size_t n) {
+    size_t size = 0;
+    while (n >= karatsuba_threshold) {
+        size_t h = (n + 1) / 2;
+        size += 2 * n + 4 * h + 4;
+        n = h + 1;
+    }
+    return size;
+}
+
+// r[0, na + nb) = a * b, r must not overlap the operands;
+// scratch must hold limbs_mul_scratch(max(na, nb)) limbs
+void limbs_mul(uint32_t* r, uint32_t const* a, size_t na, uint32_t const* b, size_t nb, uint32_t* scratch) {
+    if (na < nb) {
+        std::swap(a, b);
+        std::swap(na, nb);
+    }
+    if (nb < karatsuba_threshold) {
+        limbs_mul_basecase(r, a, na, b, nb);
+        return;
+    }
+    size_t h = (na + 1) / 2;
+    if (nb <= h) {
+        uint32_t* tmp = scratch;
+        limbs_mul(r, a, nb, b, nb, scratch + 2 * nb);
+        for (size_t k = nb; k < na; k += nb) {
+            size_t piece = std::min(nb, na - k);
+            limbs_mul(tmp, a + k, piece, b, nb, scratch + 2 * nb);
+            std::fill(r + k + nb, r + k + piece + nb, 0);
+            limbs_add(r + k, piece + nb, tmp, piece + nb);
+        }
+        return;
+    }
+    uint32_t* sa = scratch;
+    uint32_t* sb = sa + h + 1;
+    uint32_t* z1 = sb + h + 1;
+    uint32_t* rest = z1 + 2 * h + 2;
+    limbs_mul(r, a, h, b, h, rest);
+    limbs_mul(r + 2 * h, a + h, na - h, b + h, nb - h, rest);
+    std::copy(a, a + h, sa);
+    sa[h] = limbs_add(sa, h, a + h, na - h);
+    std::copy(b, b + h, sb);
+    sb[h] = limbs_add(sb, h, b + h, nb - h);
+    limbs_mul(z1, sa, h + 1, sb, h + 1, rest);
+    limbs_sub(z1, 2 * h + 2, r, 2 * h);
+    limbs_sub(z1, 2 * h + 2, r + 2 * h, na + nb - 2 * h);
+    limbs_add(r + h, na + nb - h, z1, std::min(2 * h + 2, na + nb - h));
+}
+
+uint32_t limbs_sub_1(uint32_t* r, size_t n, uint32_t b) {
+    for (size_t i = 0; i < n && b != 0; i++) {
+        uint32_t borrow = r[i] < b;
+        r[i] -= b;
+        b = borrow;
+    }
+    return b;
+}
+
+// b^(-1) mod 2^32 for odd b, each Newton step doubles the number of correct bits
+uint32_t limb_inverse(uint32_t b) {
+    uint32_t x = b;
+    for (int i = 0; i < 4; i++) {
+        x *= 2 - b * x;
+    }
+    return x;
+}
+
+int limbs_cmp(uint32_t const* a, size_t na, uint32_t const* b, size_t nb) {
+    if (na != nb) {
+        return na < nb ? -1 : 1;
+    }
+    for (size_t i = na; i > 0; i--) {
+        if (a[i - 1] != b[i - 1]) {
+            return a[i - 1] < b[i - 1] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+uint32_t limbs_divmod_1(uint32_t* q, uint32_t const* a, size_t n, uint32_t b) {
+    uint64_t rest = 0;
+    for (size_t i = n; i > 0; i--) {
+        rest = (rest << block) | a[i - 1];
+        q[i - 1] = static_cast<uint32_t>(rest / b);
+        rest %= b;
+    }
+    return static_cast<uint32_t>(rest);
+}
+
+// Division by invariant integers after Moller and Granlund: with a precomputed reciprocal of the
+// normalized divisor, a quotient limb costs a few multiplications instead of a hardware division.
+// (beta^2 - 1) / d - beta for d with the top bit set
+uint32_t limb_reciprocal(uint32_t d) {
+    return static_cast<uint32_t>(~uint64_t(0) / d - base);
+}
+
+// (beta^3 - 1) / <d1, d0> - beta for d1 with the top bit set
+uint32_t limb_reciprocal(uint32_t d1, uint32_t d0) {
+    uint32_t v = limb_reciprocal(d1);
+    uint32_t p = d1 * v + d0;
+    if (p < d0) {
+        v--;
+        if (p >= d1) {
+            v--;
+            p -= d1;
+        }
+        p -= d1;
+    }
+    uint64_t t = static_cast<uint64_t>(v) * d0;
+    p += static_cast<uint32_t>(t >> block);
+    if (p < static_cast<uint32_t>(t >> block)) {
+        v--;
+        if (((static_cast<uint64_t>(p) << block) | static_cast<uint32_t>(t)) >= ((static_cast<uint64_t>(d1) << block) | d0)) {
+            v--;
+        }
+    }
+    return v;
+}
+
+// <u1, u0> / d for u1 < d, the remainder replaces u1
+uint32_t limb_divide(uint32_t& u1, uint32_t u0, uint32_t d, uint32_t inverse) {
+    uint64_t q = static_cast<uint64_t>(inverse) * u1 + ((static_cast<uint64_t>(u1) << block) | u0);
+    auto q1 = static_cast<uint32_t>((q >> block) + 1);
+    uint32_t r = u0 - q1 * d;
+    if (r > static_cast<uint32_t>(q)) {
+        q1--;
+        r += d;
+    }
+    if (r >= d) {
+        q1++;
+        r -= d;
+    }
+    u1 = r;
+    return q1;
+}
+
+// <u2, u1, u0> / d for <u2, u1> < d, where d = <d1, d0>; the remainder goes to r
+uint32_t limb_divide(uint64_t& r, uint32_t u2, uint32_t u1, uint32_t u0, uint64_t d, uint32_t inverse) {
+    uint64_t q = static_cast<uint64_t>(inverse) * u2 + ((static_cast<uint64_t>(u2) << block) | u1);
+    auto q1 = static_cast<uint32_t>(q >> block);
+    auto d1 = static_cast<uint32_t>(d >> block);
+    uint32_t r1 = u1 - q1 * d1;
+    r = ((static_cast<uint64_t>(r1) << block) | u0) - static_cast<uint64_t>(static_cast<uint32_t>(d)) * q1 - d;
+    q1++;
+    if (static_cast<uint32_t>(r >> block) >= static_cast<uint32_t>(q)) {
+        q1--;
+        r += d;
+    }
+    if (r >= d) {
+        q1++;
+        r -= d;
+    }
+    return q1;
+}
+
+// schoolbook division of u[0, nu) by the normalized v[0, nb), nb >= 2, whose top nb limbs are below v:
+// q[0, nu - nb) gets the quotient and u[0, nb) the remainder; inverse = limb_reciprocal(v[nb - 1], v[nb - 2])
+void limbs_divide_preinv(uint32_t* q, uint32_t* u, size_t nu, uint32_t const* v, size_t nb, uint32_t inverse) {
+    uint64_t d = (static_cast<uint64_t>(v[nb - 1]) << block) | v[nb - 2];
+    for (size_t j = nu - nb; j > 0;) {
+        j--;
+        uint32_t* w = u + j;
+        uint32_t qt;
+        if (((static_cast<uint64_t>(w[nb]) << block) | w[nb - 1]) == d) {
+            // the window starts with the divisor, so the quotient limb is exactly beta - 1
+            qt = static_cast<uint32_t>(base - 1);
+            w[nb] -= kernels.submul_1(w, v, nb, qt);
+        } else {
+            uint64_t r;
+            qt = limb_divide(r, w[nb], w[nb - 1], w[nb - 2], d, inverse);
+            uint32_t borrow = kernels.submul_1(w, v, nb - 2, qt);
+            bool negative = r < borrow;
+            r -= borrow;
+            if (negative) {
+                qt--;
+                r += d + kernels.add_n(w, w, v, nb - 2);
+            }
+            w[nb - 2] = static_cast<uint32_t>(r);
+            w[nb - 1] = static_cast<uint32_t>(r >> block);
+            w[nb] = 0;
+        }
+        q[j] = qt;
+    }
+}
+
+// q[0, na - nb + 1) = a / b and u[0, nb) = a % b for nb >= 2 and a >= b,
+// u must hold na + 1 limbs and v nb limbs
+void limbs_divide(uint32_t* q, uint32_t* u, uint32_t* v, uint32_t const* a, size_t na, uint32_t const* b, size_t nb) {
+    count(counter::long_divisions);
+    unsigned s = 0;
+    while ((b[nb - 1] << s >> (block - 1)) == 0) {
+        s++;
+    }
+    if (s != 0) {
+        kernels.lshift(v, b, nb, s);
+        u[na] = kernels.lshift(u, a, na, s);
+    } else {
+        std::copy(b, b + nb, v);
+        std::copy(a, a + na, u);
+        u[na] = 0;
+    }
+    limbs_divide_preinv(q, u, na + 1, v, nb, limb_reciprocal(v[nb - 1], v[nb - 2]));
+    if (s != 0) {
+        kernels.rshift(u, u, nb, s);
+    }
+}
+
+uint32_t limbs_negate(uint32_t* r, size_t n) {
+    uint64_t carry = 1;
+    for (size_t i = 0; i < n; i++) {
+        carry += static_cast<uint32_t>(~r[i]);
+        r[i] = static_cast<uint32_t>(carry);
+        carry >>= block;
+    }
+    return static_cast<uint32_t>(carry);
+}
+
 big_integer::big_integer() :
     is_negative(false),
     number(1, 0) {}
 
-big_integer::big_integer(big_integer const& other) = default;
+big_integer::big_integer(big_integer const& other) :
+    is_negative(other.is_negative),
+    number(other.number) {
+    count(counter::copies);
+}
+
+big_integer& big_integer::operator=(big_integer const& other) {
+    count(counter::copies);
+    is_negative = other.is_negative;
+    number = other.number;
+    return *this;
+}
 
 big_integer::big_integer(unsigned long long a) : is_negative(false) {
     fill_number(a);
@@ -78,17 +354,58 @@ big_integer::big_integer(std::string const& str) {
     number = result.number;
 }
 
+big_integer::big_integer(double a) : is_negative(false) {
+    fill_float(a);
+}
+
+big_integer::big_integer(long double a) : is_negative(false) {
+    fill_float(a);
+}
+
+// the integer part of |a| limb by limb from the top: scaling by 2^32 and taking off the integer
+// part are both exact, and the limbs below the mantissa are left zero
+template <typename F>
+void big_integer::fill_float(F a) {
+    if (!std::isfinite(a)) {
+        throw std::invalid_argument("big_integer: " + std::to_string(a));
+    }
+    int exponent;
+    F rest = std::frexp(std::fabs(a), &exponent);
+    if (exponent <= 0) {
+        number.assign(1, 0);
+        return;
+    }
+    size_t n = (static_cast<size_t>(exponent) + block - 1) / block;
+    number.assign(n + 1, 0);
+    rest = std::ldexp(rest, exponent - static_cast<int>((n - 1) * block));
+    for (size_t i = n; i > 0 && rest != 0; i--) {
+        F limb = std::floor(rest);
+        number[i - 1] = static_cast<uint32_t>(limb);
+        rest = std::ldexp(rest - limb, block);
+    }
+    is_negative = a < 0 && limbs_negate(number.data(), n + 1) == 0;
+    min_length(*this);
+}
+
+big_integer big_integer::from_limbs(uint32_t const* magnitude, size_t n, bool negative) {
+    big_integer result;
+    if (n == 0) {
+        return result;
+    }
+    result.number.assign(magnitude, magnitude + n);
+    result.number.push_back(0);
+    result.is_negative = negative && limbs_negate(result.number.data(), n + 1) == 0;
+    min_length(result);
+    return result;
+}
+
 void swap(big_integer& a, big_integer& b) {
     std::swap(a.number, b.number);
     std::swap(a.is_negative, b.is_negative);
 }
 
 uint32_t big_integer::operator[](size_t i) {
-    if (i < this->number.size()) {
-        return number[i];
-    } else {
-        return get_mask();
-    }
+    return static_cast<big_integer const&>(*this)[i];
 }
 
 uint32_t big_integer::operator[](size_t i) const {
@@ -100,50 +417,177 @@ uint32_t big_integer::operator[](size_t i) const {
 }
 
 big_integer& big_integer::operator+=(big_integer const& rhs) {
-    size_t n = std::max(this->number.size(), rhs.number.size()) + 1;
-    this->number.resize(n, get_mask());
-    uint64_t result = 0;
-    for (size_t i = 0; i < n; i++) {
-        result += static_cast<uint64_t>((*this)[i]) + rhs[i];
-        number[i] = static_cast<uint32_t>(result % base);
-        result >>= block;
-    }
-    is_negative ^= (result == 1) ^ rhs.is_negative;
-    min_length(*this);
+    add_to(*this, *this, rhs, false);
     return *this;
 }
 
 big_integer& big_integer::operator-=(big_integer const& rhs) {
-    return *this += -rhs;
+    add_to(*this, *this, rhs, true);
+    return *this;
 }
 
 big_integer& big_integer::operator*=(big_integer const& rhs) {
-    bool negative = this->is_negative ^ rhs.is_negative;
-    this->abs();
-    big_integer b(rhs);
-    b.abs();
-    size_t n1 = this->number.size();
-    size_t n2 = b.number.size();
-    std::vector<uint32_t> new_number(n1 + n2, 0);
-    uint64_t result = 0;
-    for (size_t i = 0; i < n2; i++) {
-        auto element = static_cast<uint64_t>(b[i]);
-        for (size_t j = 0; j < n1; j++) {
-            result += element * (*this)[j] + new_number[i + j];
-            new_number[i + j] = static_cast<uint32_t>(result % base);
-            result /= base;
-        }
-        new_number[i + n1] += result;
-        result = 0;
-    }
-    this->number = new_number;
-    if (negative) {
-        *this = -*this;
-    }
-    min_length(*this);
+    limb_vector operands;
+    limb_vector product;
+    mul_to(*this, *this, rhs, operands, product);
     return *this;
 }
 
+void big_integer::add_to(big_integer& r, big_integer const& a, big_integer const& b, bool subtract) {
+    size_t na = a.number.size();
+    size_t nb = b.number.size();
+    uint32_t mask_a = a.get_mask();
+    uint32_t mask_b = b.get_mask();
+    size_t common = std::min(na, nb);
+    size_t n = std::max(na, nb) + 1;
+    r.number.resize(n);
+    uint32_t* pr = r.number.data();
+    uint32_t const* pa = a.number.data();
+    uint32_t const* pb = b.number.data();
+    uint64_t carry;
+    if (subtract) {
+        carry = kernels.sub_n(pr, pa, pb, common);
+        for (size_t i = common; i < n; i++) {
+            uint64_t res = static_cast<uint64_t>(i < na ? pa[i] : mask_a) - (i < nb ? pb[i] : mask_b) - carry;
+            pr[i] = static_cast<uint32_t>(res);
+            carry = res >> (2 * block - 1);
+        }
+    } else {
+        carry = kernels.add_n(pr, pa, pb, common);
+        for (size_t i = common; i < n; i++) {
+            carry += static_cast<uint64_t>(i < na ? pa[i] : mask_a) + (i < nb ? pb[i] : mask_b);
+            pr[i] = static_cast<uint32_t>(carry);
+            carry >>= block;
+        }
+    }
+    r.is_negative = (pr[n - 1] >> (block - 1)) != 0;
+    min_length(r);
+}
+
+uint32_t const* big_integer::magnitude(big_integer const& a, uint32_t* buffer, size_t& n) {
+    n = a.number.size();
+    if (!a.is_negative) {
+        return a.number.data();
+    }
+    std::copy(a.number.begin(), a.number.end(), buffer);
+    buffer[n] = limbs_negate(buffer, n);
+    n += buffer[n];
+    return buffer;
+}
+
+void big_integer::mul_to(big_integer& r, big_integer const& a, big_integer const& b,
+                         limb_vector& operands, limb_vector& product) {
+    size_t na = a.number.size();
+    size_t nb = b.number.size();
+    bool negative = a.is_negative ^ b.is_negative;
+    size_t scratch = limbs_mul_scratch(std::max(na, nb) + 1);
+    bool buffered = a.is_negative || b.is_negative || scratch != 0;
+    if (buffered) {
+        operands.resize(na + nb + 2 + scratch);
+    }
+    uint32_t* buffer_a = buffered ? operands.data() : nullptr;
+    uint32_t* buffer_b = buffered ? buffer_a + na + 1 : nullptr;
+    uint32_t* buffer_mul = buffered ? buffer_b + nb + 1 : nullptr;
+    uint32_t const* pa = magnitude(a, buffer_a, na);
+    uint32_t const* pb = magnitude(b, buffer_b, nb);
+    bool alias = &r == &a || &r == &b;
+    limb_vector& out = alias ? product : r.number;
+    out.resize(na + nb);
+    count(std::min(na, nb) < karatsuba_threshold ? counter::basecase_multiplications
+                                                 : counter::karatsuba_multiplications);
+    limbs_mul(out.data(), pa, na, pb, nb, buffer_mul);
+    if (alias) {
+        std::swap(r.number, product);
+    }
+    r.is_negative = negative && limbs_negate(r.number.data(), na + nb) == 0;
+    min_length(r);
+}
+
+namespace {
+    // pairs per block of add_n and sub_n, the lanes of kernels.add_lanes
+    size_t constexpr batch_lanes = 8;
+    // longer numbers go one at a time: at about sixteen limbs transposing them costs as much as
+    // the per-number bookkeeping it saves
+    size_t constexpr batch_max_limbs = 8;
+}
+
+// Blocks of batch_lanes short pairs are laid out structure of arrays: sign-extended to the longest
+// and transposed so that limb i of every number in the block is contiguous, then added a limb
+// position at a time with a carry per lane by kernels.add_lanes, a - b as a + ~b + 1. Other pairs
+// go through add_to. A block is read whole before its results are written, so r may alias a or b
+void big_integer::add_to_n(big_integer* r, big_integer const* a, big_integer const* b, size_t n, bool subtract) {
+    uint32_t sums[(batch_max_limbs + 1) * batch_lanes];
+    uint32_t addends[(batch_max_limbs + 1) * batch_lanes];
+    uint32_t const flip = subtract ? ~0u : 0;
+    for (size_t i = 0; i < n; i += batch_lanes) {
+        size_t count = std::min(batch_lanes, n - i);
+        size_t longest = 0;
+        for (size_t l = 0; l < count; l++) {
+            longest = std::max({longest, a[i + l].number.size(), b[i + l].number.size()});
+        }
+        if (count < batch_lanes || longest > batch_max_limbs) {
+            for (size_t l = 0; l < count; l++) {
+                add_to(r[i + l], a[i + l], b[i + l], subtract);
+            }
+            continue;
+        }
+        size_t m = longest + 1;
+        for (size_t l = 0; l < batch_lanes; l++) {
+            size_t nx = a[i + l].number.size();
+            size_t ny = b[i + l].number.size();
+            uint32_t const* px = a[i + l].number.data();
+            uint32_t const* py = b[i + l].number.data();
+            uint32_t mask_x = a[i + l].get_mask();
+            uint32_t mask_y = b[i + l].get_mask() ^ flip;
+            for (size_t k = 0; k < nx; k++) {
+                sums[k * batch_lanes + l] = px[k];
+            }
+            for (size_t k = nx; k < m; k++) {
+                sums[k * batch_lanes + l] = mask_x;
+            }
+            for (size_t k = 0; k < ny; k++) {
+                addends[k * batch_lanes + l] = py[k] ^ flip;
+            }
+            for (size_t k = ny; k < m; k++) {
+                addends[k * batch_lanes + l] = mask_y;
+            }
+        }
+        kernels.add_lanes(sums, sums, addends, m, subtract ? 1 : 0);
+        // the lengths min_length would leave, so every result is resized once
+        for (size_t l = 0; l < batch_lanes; l++) {
+            bool negative = (sums[(m - 1) * batch_lanes + l] >> (block - 1)) != 0;
+            uint32_t mask = negative ? ~0u : 0;
+            size_t length = m;
+            while (length > 1 && sums[(length - 1) * batch_lanes + l] == mask) {
+                length--;
+            }
+            big_integer& x = r[i + l];
+            x.number.resize(length);
+            uint32_t* px = x.number.data();
+            for (size_t k = 0; k < length; k++) {
+                px[k] = sums[k * batch_lanes + l];
+            }
+            x.is_negative = negative;
+        }
+    }
+}
+
+void add_n(big_integer* r, big_integer const* a, big_integer const* b, size_t n) {
+    big_integer::add_to_n(r, a, b, n, false);
+}
+
+void sub_n(big_integer* r, big_integer const* a, big_integer const* b, size_t n) {
+    big_integer::add_to_n(r, a, b, n, true);
+}
+
+void mul_n(big_integer* r, big_integer const* a, big_integer const* b, size_t n) {
+    big_integer::limb_vector operands;
+    big_integer::limb_vector product;
+    for (size_t i = 0; i < n; i++) {
+        big_integer::mul_to(r[i], a[i], b[i], operands, product);
+    }
+}
+
 void big_integer::abs() {
     if (this->is_negative) {
         *this = -*this;
@@ -151,91 +595,309 @@ void big_integer::abs() {
 }
 
 big_integer& big_integer::operator/=(big_integer const& rhs) {
-    bool negative = this->is_negative ^ rhs.is_negative;
-    this->abs();
-    big_integer b(rhs);
-    b.abs();
-    divide(*this, b);
-    if (negative) {
-        *this = -*this;
-    }
+    divide_to(this, nullptr, *this, rhs);
     return *this;
 }
 
 big_integer& big_integer::operator%=(big_integer const& rhs) {
-    bool negative = this->is_negative;
-    this->abs();
-    big_integer b(rhs);
-    b.abs();
-    *this = divide(*this, b);
-    if (negative) {
-        *this = -*this;
-    }
+    divide_to(nullptr, this, *this, rhs);
     return *this;
 }
 
+void big_integer::divide_to(big_integer* q, big_integer* r, big_integer const& a, big_integer const& b) {
+    limb_vector buffer;
+    limb_vector quotient;
+    divide_to(q, r, a, b, buffer, quotient);
+}
+
+// buffer and quotient are scratch whose blocks are reused; quotient leaves with the old limbs of q
+void big_integer::divide_to(big_integer* q, big_integer* r, big_integer const& a, big_integer const& b,
+                            limb_vector& buffer, limb_vector& quotient) {
+    count(counter::divisions);
+    size_t na = a.number.size();
+    size_t nb = b.number.size();
+    bool negative_q = a.is_negative ^ b.is_negative;
+    bool negative_r = a.is_negative;
+    buffer.assign(2 * (na + nb) + 5, 0);
+    uint32_t* u = buffer.data();
+    uint32_t* v = u + na + 2;
+    uint32_t const* pa = magnitude(a, v + nb + 1, na);
+    uint32_t const* pb = magnitude(b, v + nb + 1 + a.number.size() + 1, nb);
+    size_t nr = nb;
+    if (limbs_cmp(pa, na, pb, nb) < 0) {
+        quotient.assign(1, 0);
+        std::copy(pa, pa + na, u);
+        nr = na;
+    } else if (nb == 1) {
+        quotient.assign(na, 0);
+        u[0] = limbs_divmod_1(quotient.data(), pa, na, pb[0]);
+    } else {
+        quotient.assign(na - nb + 1, 0);
+        limbs_divide(quotient.data(), u, v, pa, na, pb, nb);
+    }
+    if (r != nullptr) {
+        r->number.assign(u, u + nr);
+        r->is_negative = negative_r && limbs_negate(r->number.data(), nr) == 0;
+        min_length(*r);
+    }
+    if (q != nullptr) {
+        std::swap(q->number, quotient);
+        q->is_negative = negative_q && limbs_negate(q->number.data(), q->number.size()) == 0;
+        min_length(*q);
+    }
+}
+
+std::pair<big_integer, big_integer> divmod(big_integer const& a, big_integer const& b) {
+    std::pair<big_integer, big_integer> result;
+    big_integer::divide_to(&result.first, &result.second, a, b);
+    return result;
+}
+
+std::pair<big_integer, big_integer> divmod_floor(big_integer const& a, big_integer const& b) {
+    std::pair<big_integer, big_integer> result = divmod(a, b);
+    if (result.second.is_negative != b.is_negative && result.second != zero) {
+        --result.first;
+        result.second += b;
+    }
+    return result;
+}
+
+namespace {
+    // floor(beta^(2n) / v) for v of n limbs with the top bit set. The reciprocal y of the top h limbs
+    // of v gives x = y * beta^(n - h) to about h limbs; one Newton step x + x * (beta^(2n) - v * x)
+    // / beta^(2n), with the error term cut to the limbs that reach the result, doubles that, and
+    // the exact remainder fixes the last few units. Multiplications of n by h limbs replace the
+    // quadratic division for long divisors
+    big_integer barrett_reciprocal(big_integer const& v, size_t n) {
+        if (n < 2 * barrett_threshold) {
+            return (big_integer(1) << static_cast<int>(2 * block * n)) / v;
+        }
+        size_t h = (n + 1) / 2;
+        int low = static_cast<int>(block * (n - h));
+        big_integer y = barrett_reciprocal(v >> low, h);
+        // beta^(2n) - v * x = error * beta^(n - h)
+        big_integer error = (big_integer(1) << static_cast<int>(block * (n + h))) - v * y;
+        big_integer delta = y * (error >> static_cast<int>(block * (h - 2))) >> static_cast<int>(block * (h + 2));
+        big_integer x = (y << low) + delta;
+        big_integer r = (error << low) - v * delta;
+        while (r < 0) {
+            x--;
+            r += v;
+        }
+        while (r >= v) {
+            x++;
+            r -= v;
+        }
+        return x;
+    }
+}
+
+big_divisor::big_divisor(big_integer const& d) :
+    divisor(d),
+    shift(0),
+    inverse(0) {
+    if (d == zero) {
+        throw std::invalid_argument("big_divisor: divisor must not be zero");
+    }
+    size_t n = d.number.size();
+    normalized.resize(n + 1);
+    uint32_t const* pd = big_integer::magnitude(d, normalized.data(), n);
+    while (n > 1 && pd[n - 1] == 0) {
+        n--;
+    }
+    while ((pd[n - 1] << shift >> (block - 1)) == 0) {
+        shift++;
+    }
+    if (shift != 0) {
+        kernels.lshift(normalized.data(), pd, n, shift);
+    } else if (pd != normalized.data()) {
+        std::copy(pd, pd + n, normalized.begin());
+    }
+    normalized.resize(n);
+    inverse = n == 1 ? limb_reciprocal(normalized[0]) : limb_reciprocal(normalized[n - 1], normalized[n - 2]);
+    if (n >= std::max<size_t>(2 * barrett_threshold, 2)) {
+        big_integer v = d;
+        v.abs();
+        big_integer x = barrett_reciprocal(v << static_cast<int>(shift), n);
+        barrett.resize(n + 1);
+        for (size_t i = 0; i <= n; i++) {
+            barrett[i] = x[i];
+        }
+    } else if (n >= std::max<size_t>(barrett_threshold, 2)) {
+        big_integer::limb_vector power(2 * n + 1, 0);
+        power[2 * n] = 1;
+        barrett.resize(n + 1);
+        limbs_divide_preinv(barrett.data(), power.data(), power.size(), normalized.data(), n, inverse);
+    }
+}
+
+big_integer const& big_divisor::value() const {
+    return divisor;
+}
+
+void big_divisor::divide_to(big_integer* q, big_integer* r, big_integer const& a) const {
+    big_integer::limb_vector u;
+    big_integer::limb_vector quotient;
+    big_integer::limb_vector buffer;
+    divide_to(q, r, a, u, quotient, buffer);
+}
+
+// u, quotient and buffer are scratch whose blocks are reused; u and quotient leave with the old
+// limbs of r and q
+void big_divisor::divide_to(big_integer* q, big_integer* r, big_integer const& a, big_integer::limb_vector& u,
+                            big_integer::limb_vector& quotient, big_integer::limb_vector& buffer) const {
+    count(counter::divisions);
+    size_t nb = normalized.size();
+    size_t na = a.number.size();
+    bool negative_q = a.is_negative ^ divisor.is_negative;
+    bool negative_r = a.is_negative;
+    u.assign(na + 2, 0);
+    uint32_t const* pa = big_integer::magnitude(a, u.data(), na);
+    if (shift != 0) {
+        u[na] = kernels.lshift(u.data(), pa, na, shift);
+    } else {
+        if (pa != u.data()) {
+            std::copy(pa, pa + na, u.begin());
+        }
+        u[na] = 0;
+    }
+    size_t nu = na + 1;
+    quotient.assign(nu > nb ? nu - nb : 1, 0);
+    if (nu > nb) {
+        if (nb == 1) {
+            uint32_t rest = u[nu - 1];
+            for (size_t j = nu - 1; j > 0;) {
+                j--;
+                quotient[j] = limb_divide(rest, u[j], normalized[0], inverse);
+            }
+            u[0] = rest;
+        } else if (!barrett.empty()) {
+            barrett_divide(quotient.data(), u.data(), nu, buffer);
+        } else {
+            limbs_divide_preinv(quotient.data(), u.data(), nu, normalized.data(), nb, inverse);
+        }
+    }
+    size_t nr = std::min(nu, nb);
+    if (shift != 0) {
+        kernels.rshift(u.data(), u.data(), nr, shift);
+    }
+    if (r != nullptr) {
+        u.resize(nr);
+        std::swap(r->number, u);
+        r->is_negative = negative_r && limbs_negate(r->number.data(), nr) == 0;
+        big_integer::min_length(*r);
+    }
+    if (q != nullptr) {
+        std::swap(q->number, quotient);
+        q->is_negative = negative_q && limbs_negate(q->number.data(), q->number.size()) == 0;
+        big_integer::min_length(*q);
+    }
+}
+
+// u[0, nu) / normalized in blocks of up to n quotient limbs; each block is estimated from the top
+// limbs of the window and the Barrett constant, at most two below the true value
+void big_divisor::barrett_divide(uint32_t* q, uint32_t* u, size_t nu, big_integer::limb_vector& buffer) const {
+    size_t n = normalized.size();
+    uint32_t const* v = normalized.data();
+    uint32_t const one = 1;
+    buffer.assign(4 * n + 2 + limbs_mul_scratch(n + 1), 0);
+    uint32_t* estimate = buffer.data();
+    uint32_t* product = estimate + 2 * n + 2;
+    uint32_t* scratch = product + 2 * n;
+    for (size_t j = nu - n; j > 0;) {
+        size_t c = std::min(n, j);
+        j -= c;
+        uint32_t* w = u + j;
+        limbs_mul(estimate, w + n - 1, c + 1, barrett.data(), n + 1, scratch);
+        uint32_t* qt = estimate + n + 1;
+        limbs_mul(product, qt, c, v, n, scratch);
+        kernels.sub_n(w, w, product, n + c);
+        while (w[n] != 0 || limbs_cmp(w, n, v, n) >= 0) {
+            w[n] -= kernels.sub_n(w, w, v, n);
+            limbs_add(qt, c, &one, 1);
+        }
+        std::copy(qt, qt + c, q + j);
+    }
+}
+
+big_integer operator/(big_integer const& a, big_divisor const& d) {
+    big_integer result;
+    d.divide_to(&result, nullptr, a);
+    return result;
+}
+
+big_integer operator%(big_integer const& a, big_divisor const& d) {
+    big_integer result;
+    d.divide_to(nullptr, &result, a);
+    return result;
+}
+
+big_integer& operator/=(big_integer& a, big_divisor const& d) {
+    d.divide_to(&a, nullptr, a);
+    return a;
+}
+
+big_integer& operator%=(big_integer& a, big_divisor const& d) {
+    d.divide_to(nullptr, &a, a);
+    return a;
+}
+
+std::pair<big_integer, big_integer> divmod(big_integer const& a, big_divisor const& d) {
+    std::pair<big_integer, big_integer> result;
+    d.divide_to(&result.first, &result.second, a);
+    return result;
+}
+
 big_integer& big_integer::operator&=(big_integer const& rhs) {
-    bin_operator(rhs, [](uint32_t a, uint32_t b){return a & b;});
+    bin_operator(rhs, kernels.and_n, [](uint32_t a, uint32_t b){return a & b;});
     return *this;
 }
 
 big_integer& big_integer::operator|=(big_integer const& rhs) {
-    bin_operator(rhs, [](uint32_t a, uint32_t b){return a | b;});
+    bin_operator(rhs, kernels.or_n, [](uint32_t a, uint32_t b){return a | b;});
     return *this;
 }
 
 big_integer& big_integer::operator^=(big_integer const& rhs) {
-    bin_operator(rhs, [](uint32_t a, uint32_t b){return a ^ b;});
+    bin_operator(rhs, kernels.xor_n, [](uint32_t a, uint32_t b){return a ^ b;});
     return *this;
 }
 
 big_integer& big_integer::operator<<=(int rhs) {
     size_t shift = rhs / block;
-    size_t left = rhs % block;
-    size_t right = block - left;
+    unsigned left = rhs % block;
     size_t n = number.size();
-    size_t ind = n + shift + 1;
-    number.resize(ind - (left == 0));
-    number[ind - 1] = get_mask() << left;
-    for (size_t i = n; i > 0; i--) {
-        number[ind - 1] += number[i - 1] >> right;
-        number[ind - 2] = number[i - 1] << left;
-        ind--;
-    }
-    ind--;
-    while (ind > 0) {
-        number[ind - 1] = 0;
-        ind--;
+    uint32_t mask = get_mask();
+    number.resize(n + shift + 1);
+    if (left == 0) {
+        std::copy_backward(number.begin(), number.begin() + n, number.begin() + n + shift);
+        number[n + shift] = mask;
+    } else {
+        uint32_t out = kernels.lshift(number.data() + shift, number.data(), n, left);
+        number[n + shift] = (mask << left) | out;
     }
+    std::fill(number.begin(), number.begin() + shift, 0);
     min_length(*this);
     return *this;
 }
 
 big_integer& big_integer::operator>>=(int rhs) {
     size_t start = rhs / block;
-    rhs %= block;
+    unsigned right = rhs % block;
     uint32_t mask = get_mask();
     size_t n = number.size();
     if (start >= n) {
-        number.clear();
-        number.push_back(mask);
+        number.assign(1, mask);
         return *this;
     }
     number.push_back(mask);
-    number.push_back(mask);
-    n += 2;
-    uint64_t result = 0;
-    number[0] = number[start] >> rhs;
-    size_t ind = 1;
-    for (size_t i = start + 1; i < n; i++) {
-        result = static_cast<uint64_t>(number[i]) << (block - rhs);
-        number[ind - 1] += result % base;
-        number[ind] = result >> block;
-        ind++;
-    }
-    for (size_t i = ind - 1; i < n; i++) {
-        number.pop_back();
+    if (right == 0) {
+        std::copy(number.begin() + start, number.end(), number.begin());
+    } else {
+        kernels.rshift(number.data(), number.data() + start, n + 1 - start, right);
     }
+    number.resize(n + 1 - start);
+    number.back() = mask;
     min_length(*this);
     return *this;
 }
@@ -253,6 +915,7 @@ big_integer big_integer::operator~() const {
 }
 
 big_integer big_integer::invert_add(big_integer tmp, uint64_t carry) {
+    count(counter::invert_add_passes);
     tmp.number.push_back(tmp.get_mask());
     size_t n = tmp.number.size();
     for (size_t i = 0; i < n; i++) {
@@ -366,183 +1029,1227 @@ bool operator>=(big_integer const& a, big_integer const& b) {
     return !(a < b);
 }
 
-std::string to_string(big_integer const& a) {
-    if (a == zero) {
-        return "0";
+big_integer big_integer::product_tree(std::vector<big_integer>& factors) {
+    if (factors.empty()) {
+        return 1;
     }
-    std::string result;
-    if (a.is_negative) {
-        result += '-';
-    }
-    std::vector<uint32_t> blocks;
-    big_integer tmp(a);
-    tmp.abs();
-    while (tmp > zero) {
-        uint32_t num = big_integer::divide_short(tmp, billion);
-        blocks.push_back(num);
-    }
-    size_t n = blocks.size();
-    result += std::to_string(blocks[n - 1]);
-    for (size_t i = n - 1; i > 0;) {
-        i--;
-        std::string s = std::to_string(blocks[i]);
-        result += std::string(len - s.length(), '0') + s;
+    auto longer = [](big_integer const& a, big_integer const& b) { return a.number.size() > b.number.size(); };
+    std::make_heap(factors.begin(), factors.end(), longer);
+    limb_vector operands;
+    limb_vector buffer;
+    big_integer smallest;
+    while (factors.size() > 1) {
+        std::pop_heap(factors.begin(), factors.end(), longer);
+        swap(smallest, factors.back());
+        factors.pop_back();
+        std::pop_heap(factors.begin(), factors.end(), longer);
+        mul_to(factors.back(), factors.back(), smallest, operands, buffer);
+        std::push_heap(factors.begin(), factors.end(), longer);
     }
+    big_integer result;
+    swap(result, factors.back());
     return result;
 }
 
-std::ostream& operator<<(std::ostream& s, big_integer const& a) {
-    return s << to_string(a);
-}
-
-uint32_t big_integer::get_mask() {
-    return this->is_negative ? static_cast<uint32_t>(base - 1) : 0;
-}
-
-uint32_t big_integer::get_mask() const {
-    return this->is_negative ? static_cast<uint32_t>(base - 1) : 0;
-}
-
-void big_integer::min_length(big_integer& a) {
-    uint32_t mask = a.get_mask();
-    while (a.number.size() > 1 && a.number[a.number.size() - 1] == mask) {
-        a.number.pop_back();
+void big_integer::push_factors(std::vector<big_integer>& factors, unsigned first, unsigned last, size_t& twos) {
+    uint64_t word = 1;
+    for (uint64_t i = first; i <= last; i++) {
+        uint64_t odd = i;
+        while (odd % 2 == 0) {
+            odd /= 2;
+            twos++;
+        }
+        if (word * odd >= base) {
+            factors.emplace_back(word);
+            word = 1;
+        }
+        word *= odd;
     }
+    factors.emplace_back(word);
 }
 
-void big_integer::resize(big_integer& a, size_t sz) {
-    uint32_t mask = a.get_mask();
-    size_t n = sz - a.number.size();
-    while (n > 0) {
-        a.number.push_back(mask);
-        n--;
-    }
+big_integer product(big_integer const* first, size_t n) {
+    std::vector<big_integer> factors(first, first + n);
+    return big_integer::product_tree(factors);
 }
 
-void big_integer::bin_operator(big_integer const& rhs, const std::function<uint32_t (uint32_t, uint32_t)>& f) {
-    size_t n = std::max(number.size(), rhs.number.size());
-    big_integer::resize(*this, n);
+big_integer sum(big_integer const* first, size_t n) {
+    big_integer result;
+    size_t longest = 0;
     for (size_t i = 0; i < n; i++) {
-        number[i] = f((*this)[i], rhs[i]);
+        longest = std::max(longest, first[i].number.size());
     }
-    is_negative = f(is_negative, rhs.is_negative);
-    min_length(*this);
+    result.number.reserve(longest + 3);
+    for (size_t i = 0; i < n; i++) {
+        result += first[i];
+    }
+    return result;
 }
 
-uint32_t big_integer::divide_short(big_integer& a, uint32_t const b) {
-    size_t n = a.number.size();
-    uint64_t res = 0;
-    while (n > 0) {
-        n--;
-        res += a.number[n];
-        a.number[n] = res / b;
-        res %= b;
-        res <<= block;
+big_integer factorial(unsigned n) {
+    std::vector<big_integer> factors;
+    size_t twos = 0;
+    if (n > 1) {
+        big_integer::push_factors(factors, 2, n, twos);
     }
-    res >>= block;
-    min_length(a);
-    return static_cast<uint32_t>(res);
+    return big_integer::product_tree(factors) <<= static_cast<int>(twos);
 }
 
-big_integer big_integer::divide(big_integer& a, big_integer& b) {
-    if (a < b) {
-        big_integer old(a);
-        a.number.clear();
-        a.number.push_back(0);
-        return old;
+big_integer binomial(unsigned n, unsigned k) {
+    if (k > n) {
+        return 0;
     }
-    if (b.number.size() == 1) {
-        return static_cast<big_integer>(divide_short(a, b[0]));
+    k = std::min(k, n - k);
+    if (k == 0) {
+        return 1;
     }
-    return long_divide(a, b);
-}
-
-uint32_t trial(std::vector<uint32_t> &a, uint32_t b) {
-    auto qt = static_cast<uint64_t>(a.back());
-    qt = ((qt << block) + a[a.size() - 2]) / b;
-    qt = std::min(qt, base - 1);
-    return static_cast<uint32_t>(qt);
+    std::vector<big_integer> factors;
+    size_t twos = 0;
+    big_integer::push_factors(factors, n - k + 1, n, twos);
+    big_integer numerator = big_integer::product_tree(factors);
+    size_t denominator_twos = 0;
+    factors.clear();
+    big_integer::push_factors(factors, 2, k, denominator_twos);
+    numerator = divexact(numerator, big_integer::product_tree(factors));
+    return numerator <<= static_cast<int>(twos - denominator_twos);
 }
 
-bool smaller(std::vector<uint32_t> &a, std::vector<uint32_t> &b) {
-    for (size_t i = a.size(); i > 0; i--) {
-        if (a[i - 1] != b[i - 1]) {
-            return a[i - 1] < b[i - 1];
+// strips the common power of two, leaving |b| odd; false if a is not divisible by that power
+bool big_integer::hensel_operands(big_integer const& a, big_integer const& b,
+                                  limb_vector& na, limb_vector& nb) {
+    size_t sa = a.number.size();
+    size_t sb = b.number.size();
+    limb_vector buffer(sa + sb + 2);
+    uint32_t const* pa = magnitude(a, buffer.data(), sa);
+    uint32_t const* pb = magnitude(b, buffer.data() + a.number.size() + 1, sb);
+    size_t zeros = 0;
+    while (zeros + 1 < sb && pb[zeros] == 0) {
+        if (zeros < sa && pa[zeros] != 0) {
+            return false;
         }
+        zeros++;
     }
-    return false;
+    unsigned bits = 0;
+    while (bits + 1 < block && (pb[zeros] >> bits & 1) == 0) {
+        bits++;
+    }
+    if (zeros < sa && (pa[zeros] & ((1U << bits) - 1)) != 0) {
+        return false;
+    }
+    na.assign(pa + std::min(zeros, sa), pa + sa);
+    nb.assign(pb + zeros, pb + sb);
+    if (na.empty()) {
+        na.push_back(0);
+    }
+    if (bits != 0) {
+        kernels.rshift(na.data(), na.data(), na.size(), bits);
+        kernels.rshift(nb.data(), nb.data(), nb.size(), bits);
+    }
+    while (na.size() > 1 && na.back() == 0) {
+        na.pop_back();
+    }
+    while (nb.size() > 1 && nb.back() == 0) {
+        nb.pop_back();
+    }
+    return true;
 }
 
-void difference(std::vector<uint32_t> &a, std::vector<uint32_t> &b) {
-    uint64_t res = static_cast<uint64_t>(~b[0]) + a[0] + 1LL;
-    uint64_t carry = res >> block;
-    a[0] = static_cast<uint32_t>(res);
-    for (size_t i = 1; i < b.size(); i++) {
-        res = static_cast<uint64_t>(~b[i]) + a[i] + carry;
-        a[i] = static_cast<uint32_t>(res);
-        carry = res >> block;
+big_integer divexact(big_integer const& a, big_integer const& b) {
+    big_integer::limb_vector na;
+    big_integer::limb_vector nb;
+    big_integer result;
+    big_integer::hensel_operands(a, b, na, nb);
+    if (na.size() < nb.size()) {
+        return result;
+    }
+    size_t n = na.size() - nb.size() + 1;
+    size_t m = nb.size();
+    uint32_t inverse = limb_inverse(nb[0]);
+    result.number.resize(n);
+    for (size_t i = 0; i < n; i++) {
+        uint32_t q = na[i] * inverse;
+        result.number[i] = q;
+        size_t length = std::min(m, n - i);
+        uint32_t borrow = kernels.submul_1(na.data() + i, nb.data(), length, q);
+        limbs_sub_1(na.data() + i + length, n - i - length, borrow);
     }
+    result.is_negative = (a.is_negative ^ b.is_negative) && limbs_negate(result.number.data(), n) == 0;
+    big_integer::min_length(result);
+    return result;
 }
 
-void product(std::vector<uint32_t> & result, std::vector<uint32_t> &a, uint32_t b) {
-    size_t n = a.size();
-    result.resize(n + 1);
-    uint64_t carry = 0;
-    uint64_t tmp;
-    uint64_t res;
+bool divisible_by(big_integer const& a, big_integer const& b) {
+    if (b == zero) {
+        return a == zero;
+    }
+    big_integer::limb_vector na;
+    big_integer::limb_vector nb;
+    if (!big_integer::hensel_operands(a, b, na, nb)) {
+        return false;
+    }
+    if (na.size() < nb.size()) {
+        return na.size() == 1 && na[0] == 0;
+    }
+    size_t n = na.size() - nb.size() + 1;
+    size_t m = nb.size();
+    uint32_t inverse = limb_inverse(nb[0]);
     for (size_t i = 0; i < n; i++) {
-        tmp = static_cast<uint64_t>(a[i]) * b;
-        res = (tmp << block >> block) + carry;
-        result[i] = static_cast<uint32_t>(res);
-        carry = (tmp >> block) + (res >> block);
+        uint32_t borrow = kernels.submul_1(na.data() + i, nb.data(), m, na[i] * inverse);
+        if (limbs_sub_1(na.data() + i + m, na.size() - i - m, borrow) != 0) {
+            return false;
+        }
     }
-    result[n] = static_cast<uint32_t>(carry);
+    return std::all_of(na.begin() + n, na.end(), [](uint32_t x) { return x == 0; });
 }
 
-void shift(std::vector<uint32_t> &a) {
-    for (size_t j = a.size() - 1; j > 0; j--) {
-        a[j] = a[j - 1];
+namespace {
+    using limb_buffer = std::vector<uint32_t, big_integer_detail::limb_allocator>;
+    uint32_t static constexpr small_prime_limit = 1000;
+    size_t static constexpr sieve_window = 4096;
+
+    uint32_t limbs_mod_1(uint32_t const* a, size_t n, uint32_t d) {
+        uint64_t rest = 0;
+        for (size_t i = n; i > 0; i--) {
+            rest = ((rest << block) | a[i - 1]) % d;
+        }
+        return static_cast<uint32_t>(rest);
+    }
+
+    // r[0, n) = beta^k mod m[0, n) for k >= n
+    void limbs_power_of_base_mod(uint32_t* r, size_t k, uint32_t const* m, size_t n) {
+        limb_buffer buffer(3 * k + 4, 0);
+        uint32_t* a = buffer.data();
+        uint32_t* q = a + k + 1;
+        uint32_t* u = q + k + 1;
+        a[k] = 1;
+        if (n == 1) {
+            r[0] = limbs_divmod_1(q, a, k + 1, m[0]);
+            return;
+        }
+        limb_buffer v(n);
+        limbs_divide(q, u, v.data(), a, k + 1, m, n);
+        std::copy(u, u + n, r);
+    }
+
+    size_t limbs_bit_length(uint32_t const* a, size_t n) {
+        while (n > 0 && a[n - 1] == 0) {
+            n--;
+        }
+        if (n == 0) {
+            return 0;
+        }
+        size_t bits = n * block;
+        for (uint32_t top = a[n - 1]; (top >> (block - 1)) == 0; top <<= 1) {
+            bits--;
+        }
+        return bits;
+    }
+
+    bool limbs_bit(uint32_t const* a, size_t i) {
+        return (a[i / block] >> (i % block) & 1) != 0;
+    }
+
+    bool limbs_zero(uint32_t const* a, size_t n) {
+        return std::all_of(a, a + n, [](uint32_t x) { return x == 0; });
+    }
+
+    // Montgomery arithmetic modulo an odd m of n limbs: x is kept as x * beta^n mod m in n limbs,
+    // so a product is reduced by n multiply-adds of m from the bottom instead of by a division
+    struct montgomery {
+        montgomery(uint32_t const* modulus, size_t size) :
+            n(size),
+            m(modulus, modulus + size),
+            inverse(0 - limb_inverse(modulus[0])),
+            one(size),
+            square(size),
+            product(2 * size),
+            scratch(limbs_mul_scratch(size)),
+            a2(size) {
+            limbs_power_of_base_mod(one.data(), n, m.data(), n);
+            limbs_power_of_base_mod(square.data(), 2 * n, m.data(), n);
+        }
+
+        // r = a * b, r may alias the operands
+        void mul(uint32_t* r, uint32_t const* a, uint32_t const* b) {
+            limbs_mul(product.data(), a, n, b, n, scratch.data());
+            reduce(r);
+        }
+
+        void add(uint32_t* r, uint32_t const* a, uint32_t const* b) const {
+            uint32_t carry = kernels.add_n(r, a, b, n);
+            if (carry != 0 || limbs_cmp(r, n, m.data(), n) >= 0) {
+                kernels.sub_n(r, r, m.data(), n);
+            }
+        }
+
+        void sub(uint32_t* r, uint32_t const* a, uint32_t const* b) const {
+            if (kernels.sub_n(r, a, b, n) != 0) {
+                kernels.add_n(r, r, m.data(), n);
+            }
+        }
+
+        // r = a / 2, adding m first to an odd a
+        void half(uint32_t* r, uint32_t const* a) const {
+            uint32_t carry = 0;
+            if ((a[0] & 1) != 0) {
+                carry = kernels.add_n(r, a, m.data(), n);
+            } else if (r != a) {
+                std::copy(a, a + n, r);
+            }
+            kernels.rshift(r, r, n, 1);
+            r[n - 1] |= carry << (block - 1);
+        }
+
+        // a < m into the form and back
+        void to_form(uint32_t* r, uint32_t const* a) {
+            mul(r, a, square.data());
+        }
+
+        void from_form(uint32_t* r, uint32_t const* a) {
+            std::copy(a, a + n, product.begin());
+            std::fill(product.begin() + n, product.end(), 0);
+            reduce(r);
+        }
+
+        // r = a^e for e[0, ne), left to right with sliding windows of up to 5 bits;
+        // the table of powers only grows, so repeated calls reuse it
+        void pow(uint32_t* r, uint32_t const* a, uint32_t const* e, size_t ne) {
+            size_t bits = limbs_bit_length(e, ne);
+            size_t k = 1;
+            for (size_t limit : {24, 80, 240, 672}) {
+                k += bits > limit;
+            }
+            // a, a^3, ..., a^(2^k - 1)
+            size_t table = (size_t(1) << (k - 1)) * n;
+            if (odd_powers.size() < table) {
+                odd_powers.resize(table);
+            }
+            std::copy(a, a + n, odd_powers.begin());
+            if (k > 1) {
+                mul(a2.data(), a, a);
+                for (size_t i = n; i < table; i += n) {
+                    mul(odd_powers.data() + i, odd_powers.data() + i - n, a2.data());
+                }
+            }
+            std::copy(one.begin(), one.end(), r);
+            bool started = false;
+            for (size_t i = bits; i > 0;) {
+                if (!limbs_bit(e, i - 1)) {
+                    mul(r, r, r);
+                    i--;
+                    continue;
+                }
+                size_t low = i > k ? i - k : 0;
+                while (!limbs_bit(e, low)) {
+                    low++;
+                }
+                size_t window = 0;
+                for (size_t j = i; j > low;) {
+                    j--;
+                    window = window << 1 | limbs_bit(e, j);
+                    if (started) {
+                        mul(r, r, r);
+                    }
+                }
+                uint32_t const* power = odd_powers.data() + (window >> 1) * n;
+                if (started) {
+                    mul(r, r, power);
+                } else {
+                    std::copy(power, power + n, r);
+                    started = true;
+                }
+                i = low;
+            }
+        }
+
+        size_t n;
+        limb_buffer m;
+        uint32_t inverse;
+        limb_buffer one;
+        limb_buffer square;
+
+    private:
+        // r = product * beta^(-n): each step adds the multiple of m that clears the lowest limb,
+        // its carry is kept in the cleared limb and added back at the end
+        void reduce(uint32_t* r) {
+            uint32_t* t = product.data();
+            for (size_t i = 0; i < n; i++) {
+                t[i] = kernels.addmul_1(t + i, m.data(), n, t[i] * inverse);
+            }
+            uint32_t carry = kernels.add_n(r, t + n, t, n);
+            if (carry != 0 || limbs_cmp(r, n, m.data(), n) >= 0) {
+                kernels.sub_n(r, r, m.data(), n);
+            }
+        }
+
+        limb_buffer product;
+        limb_buffer scratch;
+        limb_buffer a2;
+        limb_buffer odd_powers;
+    };
+
+    // odd primes below small_prime_limit, grouped into runs whose products fit a limb
+    struct small_primes {
+        std::vector<uint32_t> primes;
+        std::vector<uint32_t> group;
+        std::vector<uint32_t> products;
+    };
+
+    small_primes const& get_small_primes() {
+        static small_primes const table = [] {
+            small_primes result;
+            std::vector<bool> composite(small_prime_limit);
+            for (uint32_t p = 3; p < small_prime_limit; p += 2) {
+                if (composite[p]) {
+                    continue;
+                }
+                for (uint32_t q = p * p; q < small_prime_limit; q += 2 * p) {
+                    composite[q] = true;
+                }
+                if (result.products.empty() || static_cast<uint64_t>(result.products.back()) * p >= base) {
+                    result.products.push_back(1);
+                }
+                result.products.back() *= p;
+                result.primes.push_back(p);
+                result.group.push_back(static_cast<uint32_t>(result.products.size() - 1));
+            }
+            return result;
+        }();
+        return table;
+    }
+
+    // a mod p for every small prime p, from a single pass over the limbs of a
+    // that keeps the remainders modulo the products of the groups
+    std::vector<uint32_t> small_remainders(uint32_t const* a, size_t n) {
+        small_primes const& table = get_small_primes();
+        std::vector<uint64_t> rest(table.products.size(), 0);
+        for (size_t i = n; i > 0; i--) {
+            for (size_t g = 0; g < rest.size(); g++) {
+                rest[g] = ((rest[g] << block) | a[i - 1]) % table.products[g];
+            }
+        }
+        std::vector<uint32_t> result(table.primes.size());
+        for (size_t i = 0; i < result.size(); i++) {
+            result[i] = static_cast<uint32_t>(rest[table.group[i]] % table.primes[i]);
+        }
+        return result;
+    }
+
+    // Jacobi symbol (a / b) for an odd b
+    int jacobi(uint32_t a, uint32_t b) {
+        int result = 1;
+        a %= b;
+        while (a != 0) {
+            while (a % 2 == 0) {
+                a /= 2;
+                if (b % 8 == 3 || b % 8 == 5) {
+                    result = -result;
+                }
+            }
+            std::swap(a, b);
+            if (a % 4 == 3 && b % 4 == 3) {
+                result = -result;
+            }
+            a %= b;
+        }
+        return b == 1 ? result : 0;
+    }
+
+    // (d / a) for an odd a > d > 0 of n limbs and an odd d, by quadratic reciprocity
+    int jacobi(int64_t d, uint32_t const* a, size_t n) {
+        auto magnitude = static_cast<uint32_t>(d < 0 ? -d : d);
+        int result = jacobi(limbs_mod_1(a, n, magnitude), magnitude);
+        if (magnitude % 4 == 3 && a[0] % 4 == 3) {
+            result = -result;
+        }
+        if (d < 0 && a[0] % 4 == 3) {
+            result = -result;
+        }
+        return result;
+    }
+
+    bool is_square(big_integer const& a, size_t n) {
+        // Newton's iteration from above settles at floor(sqrt(a))
+        big_integer x = big_integer(1) << static_cast<int>(n * block / 2 + 1);
+        while (true) {
+            big_integer y = (x + a / x) >> 1;
+            if (y >= x) {
+                break;
+            }
+            x = y;
+        }
+        return x * x == a;
+    }
+
+    // strong probable prime to base 2: a - 1 = d * 2^s, then 2^d = 1 or 2^(d * 2^r) = -1 for some r < s
+    bool miller_rabin_base_2(montgomery& mont, uint32_t const* a) {
+        size_t n = mont.n;
+        limb_buffer d(a, a + n);
+        d[0]--;
+        size_t s = 0;
+        while (!limbs_bit(d.data(), s)) {
+            s++;
+        }
+        limb_buffer buffer(3 * n, 0);
+        uint32_t* x = buffer.data();
+        uint32_t* minus_one = x + n;
+        uint32_t* zero_form = minus_one + n;
+        mont.sub(minus_one, zero_form, mont.one.data());
+        mont.add(x, mont.one.data(), mont.one.data());
+        // 2^d = 2^(d >> s) squared s times, so the exponent needs no shifting
+        limb_buffer e(n);
+        size_t whole = s / block;
+        std::copy(d.begin() + whole, d.end(), e.begin());
+        if (s % block != 0) {
+            kernels.rshift(e.data(), e.data(), n - whole, s % block);
+        }
+        mont.pow(x, x, e.data(), n - whole);
+        if (std::equal(x, x + n, mont.one.begin()) || std::equal(x, x + n, minus_one)) {
+            return true;
+        }
+        for (size_t r = 1; r < s; r++) {
+            mont.mul(x, x, x);
+            if (std::equal(x, x + n, minus_one)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // strong Lucas probable prime with Selfridge's parameters: the first D of 5, -7, 9, -11, ...
+    // with (D / a) = -1, P = 1 and Q = (1 - D) / 4; then a + 1 = d * 2^s and U_d = 0 or V_(d * 2^r) = 0
+    // for some r < s
+    bool strong_lucas(montgomery& mont, uint32_t const* a) {
+        size_t n = mont.n;
+        int64_t d = 5;
+        for (;; d = d > 0 ? -d - 2 : -d + 2) {
+            int j = jacobi(d, a, n);
+            if (j == -1) {
+                break;
+            }
+            if (j == 0) {
+                return false;
+            }
+            if (d == 61 && is_square(big_integer::from_limbs(a, n, false), n)) {
+                return false;
+            }
+        }
+        limb_buffer buffer(7 * n, 0);
+        uint32_t* u = buffer.data();
+        uint32_t* v = u + n;
+        uint32_t* qk = v + n;
+        uint32_t* d_form = qk + n;
+        uint32_t* q_form = d_form + n;
+        uint32_t* t = q_form + n;
+        uint32_t* zero_form = t + n;
+        auto to_form = [&mont, zero_form](uint32_t* r, int64_t value) {
+            std::fill(r, r + mont.n, 0);
+            r[0] = static_cast<uint32_t>(value < 0 ? -value : value);
+            mont.to_form(r, r);
+            if (value < 0) {
+                mont.sub(r, zero_form, r);
+            }
+        };
+        to_form(d_form, d);
+        to_form(q_form, (1 - d) / 4);
+
+        uint32_t const one_limb = 1;
+        limb_buffer e(a, a + n);
+        e.push_back(limbs_add(e.data(), n, &one_limb, 1));
+        size_t s = 0;
+        while (!limbs_bit(e.data(), s)) {
+            s++;
+        }
+        size_t bits = limbs_bit_length(e.data(), e.size());
+        std::copy(mont.one.begin(), mont.one.end(), u);
+        std::copy(mont.one.begin(), mont.one.end(), v);
+        std::copy(q_form, q_form + n, qk);
+        for (size_t i = bits - 1; i > s; i--) {
+            // U_2k = U_k V_k, V_2k = V_k^2 - 2 Q^k
+            mont.mul(u, u, v);
+            mont.mul(v, v, v);
+            mont.sub(v, v, qk);
+            mont.sub(v, v, qk);
+            mont.mul(qk, qk, qk);
+            if (limbs_bit(e.data(), i - 1)) {
+                // U_(k+1) = (P U_k + V_k) / 2, V_(k+1) = (D U_k + P V_k) / 2
+                mont.add(t, u, v);
+                mont.mul(u, d_form, u);
+                mont.add(v, u, v);
+                mont.half(v, v);
+                mont.half(u, t);
+                mont.mul(qk, qk, q_form);
+            }
+        }
+        if (limbs_zero(u, n) || limbs_zero(v, n)) {
+            return true;
+        }
+        for (size_t r = 1; r < s; r++) {
+            mont.mul(v, v, v);
+            mont.sub(v, v, qk);
+            mont.sub(v, v, qk);
+            if (limbs_zero(v, n)) {
+                return true;
+            }
+            mont.mul(qk, qk, qk);
+        }
+        return false;
+    }
+
+    // Baillie-PSW for an odd a[0, n) above small_prime_limit without small factors
+    bool baillie_psw(uint32_t const* a, size_t n) {
+        montgomery mont(a, n);
+        return miller_rabin_base_2(mont, a) && strong_lucas(mont, a);
+    }
+}
+
+big_integer pow_mod(big_integer const& base, big_integer const& exponent, big_integer const& modulus) {
+    if (modulus <= zero) {
+        throw std::invalid_argument("pow_mod: modulus must be positive");
+    }
+    if (exponent < zero) {
+        throw std::invalid_argument("pow_mod: exponent must not be negative");
+    }
+    big_integer a = base % modulus;
+    if (a.is_negative) {
+        a += modulus;
+    }
+    size_t n = modulus.number.size();
+    while (modulus.number[n - 1] == 0) {
+        n--;
+    }
+    uint32_t const* e = exponent.number.data();
+    size_t ne = exponent.number.size();
+    if ((modulus.number[0] & 1) != 0) {
+        montgomery mont(modulus.number.data(), n);
+        limb_buffer x(n, 0);
+        std::copy(a.number.begin(), a.number.begin() + std::min(n, a.number.size()), x.begin());
+        mont.to_form(x.data(), x.data());
+        mont.pow(x.data(), x.data(), e, ne);
+        mont.from_form(x.data(), x.data());
+        return big_integer::from_limbs(x.data(), n, false);
+    }
+    // an even modulus has no Montgomery form, square and multiply with a prepared divisor instead
+    big_divisor d(modulus);
+    big_integer result = big_integer(1) % d;
+    for (size_t i = limbs_bit_length(e, ne); i > 0; i--) {
+        result = result * result % d;
+        if (limbs_bit(e, i - 1)) {
+            result = result * a % d;
+        }
+    }
+    return result;
+}
+
+// the Montgomery arithmetic and the buffers of the binary extended gcd, R^3 turns (a * R)^(-1)
+// back into a^(-1) * R
+struct mod_context::state {
+    state(uint32_t const* m, size_t n) :
+        mont(m, n),
+        cube(n),
+        u(n),
+        v(n),
+        x1(n),
+        x2(n) {
+        mont.mul(cube.data(), mont.square.data(), mont.square.data());
+    }
+
+    montgomery mont;
+    limb_buffer cube;
+    limb_buffer u;
+    limb_buffer v;
+    limb_buffer x1;
+    limb_buffer x2;
+};
+
+mod_context::mod_context(big_integer const& modulus) :
+    modulus_(modulus) {
+    if (modulus <= 1 || (modulus.number[0] & 1) == 0) {
+        throw std::invalid_argument("mod_context: modulus must be odd and greater than 1");
+    }
+    size_t n = modulus.number.size();
+    while (modulus.number[n - 1] == 0) {
+        n--;
+    }
+    data.reset(new state(modulus.number.data(), n));
+}
+
+mod_context::~mod_context() = default;
+
+big_integer const& mod_context::modulus() const {
+    return modulus_;
+}
+
+void mod_context::add(residue& r, residue const& a, residue const& b) {
+    data->mont.add(r.number.data(), a.number.data(), b.number.data());
+}
+
+void mod_context::sub(residue& r, residue const& a, residue const& b) {
+    data->mont.sub(r.number.data(), a.number.data(), b.number.data());
+}
+
+void mod_context::mul(residue& r, residue const& a, residue const& b) {
+    data->mont.mul(r.number.data(), a.number.data(), b.number.data());
+}
+
+void mod_context::pow(residue& r, residue const& a, big_integer const& exponent) {
+    if (exponent < zero) {
+        throw std::invalid_argument("pow: exponent must not be negative");
+    }
+    data->mont.pow(r.number.data(), a.number.data(), exponent.number.data(), exponent.number.size());
+}
+
+// x1 * a = u and x2 * a = v modulo m hold throughout, starting from u = a and v = m;
+// halving u and v halves x1 and x2, and the smaller of u and v is taken from the larger
+// until one of them is 1
+void mod_context::inverse(residue& r, residue const& a) {
+    montgomery& mont = data->mont;
+    size_t n = mont.n;
+    uint32_t* u = data->u.data();
+    uint32_t* v = data->v.data();
+    uint32_t* x1 = data->x1.data();
+    uint32_t* x2 = data->x2.data();
+    std::copy(a.number.begin(), a.number.end(), u);
+    std::copy(mont.m.begin(), mont.m.end(), v);
+    std::fill(x1, x1 + n, 0);
+    std::fill(x2, x2 + n, 0);
+    x1[0] = 1;
+    auto is_one = [n](uint32_t const* x) { return x[0] == 1 && limbs_zero(x + 1, n - 1); };
+    uint32_t const* result;
+    while (true) {
+        if (limbs_zero(u, n)) {
+            throw std::invalid_argument("inverse: the value is not coprime to the modulus");
+        }
+        while ((u[0] & 1) == 0) {
+            kernels.rshift(u, u, n, 1);
+            mont.half(x1, x1);
+        }
+        while ((v[0] & 1) == 0) {
+            kernels.rshift(v, v, n, 1);
+            mont.half(x2, x2);
+        }
+        if (is_one(u) || is_one(v)) {
+            result = is_one(u) ? x1 : x2;
+            break;
+        }
+        if (limbs_cmp(u, n, v, n) >= 0) {
+            kernels.sub_n(u, u, v, n);
+            mont.sub(x1, x1, x2);
+        } else {
+            kernels.sub_n(v, v, u, n);
+            mont.sub(x2, x2, x1);
+        }
+    }
+    mont.mul(r.number.data(), result, data->cube.data());
+}
+
+residue::residue(mod_context& context) :
+    context(&context),
+    number(context.data->mont.n, 0) {}
+
+residue::residue(mod_context& context, big_integer const& a) : residue(context) {
+    big_integer x = a % context.modulus_;
+    if (x.is_negative) {
+        x += context.modulus_;
+    }
+    std::copy(x.number.begin(), x.number.begin() + std::min(number.size(), x.number.size()), number.begin());
+    context.data->mont.to_form(number.data(), number.data());
+}
+
+big_integer residue::value() const {
+    limb_buffer x(number.size());
+    context->data->mont.from_form(x.data(), number.data());
+    return big_integer::from_limbs(x.data(), x.size(), false);
+}
+
+residue& residue::operator+=(residue const& rhs) {
+    context->add(*this, *this, rhs);
+    return *this;
+}
+
+residue& residue::operator-=(residue const& rhs) {
+    context->sub(*this, *this, rhs);
+    return *this;
+}
+
+residue& residue::operator*=(residue const& rhs) {
+    context->mul(*this, *this, rhs);
+    return *this;
+}
+
+residue operator+(residue a, residue const& b) {
+    return a += b;
+}
+
+residue operator-(residue a, residue const& b) {
+    return a -= b;
+}
+
+residue operator*(residue a, residue const& b) {
+    return a *= b;
+}
+
+bool operator==(residue const& a, residue const& b) {
+    return a.number == b.number;
+}
+
+bool operator!=(residue const& a, residue const& b) {
+    return !(a == b);
+}
+
+bool is_probable_prime(big_integer const& a) {
+    if (a.is_negative) {
+        return false;
+    }
+    size_t n = a.number.size();
+    while (n > 1 && a.number[n - 1] == 0) {
+        n--;
     }
+    uint32_t const* p = a.number.data();
+    small_primes const& table = get_small_primes();
+    if (n == 1 && p[0] < small_prime_limit) {
+        return p[0] == 2 || std::binary_search(table.primes.begin(), table.primes.end(), p[0]);
+    }
+    if ((p[0] & 1) == 0) {
+        return false;
+    }
+    std::vector<uint32_t> rest = small_remainders(p, n);
+    if (std::find(rest.begin(), rest.end(), 0) != rest.end()) {
+        return false;
+    }
+    return baillie_psw(p, n);
+}
+
+// candidates come from sieving a window of odd numbers by the small primes,
+// only the survivors get the Baillie-PSW test
+big_integer next_prime(big_integer const& a) {
+    small_primes const& table = get_small_primes();
+    if (a < small_prime_limit) {
+        if (a < 2) {
+            return 2;
+        }
+        auto it = std::upper_bound(table.primes.begin(), table.primes.end(), a.number[0]);
+        if (it != table.primes.end()) {
+            return *it;
+        }
+    }
+    big_integer start = a + 1;
+    start.number[0] |= 1;
+    std::vector<bool> composite(sieve_window);
+    while (true) {
+        size_t n = start.number.size();
+        while (start.number[n - 1] == 0) {
+            n--;
+        }
+        std::vector<uint32_t> rest = small_remainders(start.number.data(), n);
+        std::fill(composite.begin(), composite.end(), false);
+        for (size_t i = 0; i < table.primes.size(); i++) {
+            // start + 2k = 0 (mod p) for k = -rest / 2 (mod p)
+            uint32_t p = table.primes[i];
+            size_t k = (p - rest[i]) % p * ((p + 1) / 2) % p;
+            for (; k < sieve_window; k += p) {
+                composite[k] = true;
+            }
+        }
+        for (size_t k = 0; k < sieve_window; k++) {
+            if (composite[k]) {
+                continue;
+            }
+            big_integer candidate = start + big_integer(static_cast<unsigned long long>(2 * k));
+            size_t nc = candidate.number.size();
+            while (candidate.number[nc - 1] == 0) {
+                nc--;
+            }
+            if (baillie_psw(candidate.number.data(), nc)) {
+                return candidate;
+            }
+        }
+        start += big_integer(static_cast<unsigned long long>(2 * sieve_window));
+    }
+}
+
+// xxHash64 rounds over pairs of limbs in four independent lanes, so the multiplications of
+// neighbouring words overlap; the lanes are folded with the length and the sign at the end
+namespace {
+    uint64_t static constexpr hash_prime_1 = 0x9E3779B185EBCA87ULL;
+    uint64_t static constexpr hash_prime_2 = 0xC2B2AE3D27D4EB4FULL;
+    uint64_t static constexpr hash_prime_3 = 0x165667B19E3779F9ULL;
+
+    uint64_t rotate_left(uint64_t x, unsigned r) {
+        return (x << r) | (x >> (64 - r));
+    }
+
+    uint64_t hash_round(uint64_t lane, uint64_t word) {
+        return rotate_left(lane + word * hash_prime_2, 31) * hash_prime_1;
+    }
+
+    uint64_t limb_pair(uint32_t const* p) {
+        return static_cast<uint64_t>(p[1]) << block | p[0];
+    }
+}
+
+size_t std::hash<big_integer>::operator()(big_integer const& a) const noexcept {
+    uint32_t const* p = a.number.data();
+    size_t n = a.number.size();
+    uint64_t lanes[4] = {hash_prime_1 + hash_prime_2, hash_prime_2, 0, 0 - hash_prime_1};
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        for (size_t j = 0; j < 4; j++) {
+            lanes[j] = hash_round(lanes[j], limb_pair(p + i + 2 * j));
+        }
+    }
+    uint64_t h = rotate_left(lanes[0], 1) + rotate_left(lanes[1], 7) + rotate_left(lanes[2], 12) +
+                 rotate_left(lanes[3], 18);
+    for (; i + 2 <= n; i += 2) {
+        h = rotate_left(h ^ hash_round(0, limb_pair(p + i)), 27) * hash_prime_1 + hash_prime_3;
+    }
+    if (i < n) {
+        h = rotate_left(h ^ (p[i] * hash_prime_1), 23) * hash_prime_2 + hash_prime_3;
+    }
+    h ^= (static_cast<uint64_t>(n) << 1) | a.is_negative;
+    h ^= h >> 33;
+    h *= hash_prime_2;
+    h ^= h >> 29;
+    h *= hash_prime_3;
+    h ^= h >> 32;
+    return static_cast<size_t>(h);
+}
+
+// |a| = m * 2^shift with m rounded to the digits of F, ties to even. Limb i of |a| is read in place
+// even for a negative a: it is ~a[i] above the lowest nonzero limb, -a[i] at it and zero below,
+// so only the top limbs are touched besides the scan for the lowest nonzero one, which for
+// anything but a multiple of a large power of two stops at the first limb
+template <typename F>
+F big_integer::round_to_float(big_integer const& a, long& shift) {
+    uint32_t const* p = a.number.data();
+    size_t n = a.number.size();
+    size_t lowest = 0;
+    while (lowest < n && p[lowest] == 0) {
+        lowest++;
+    }
+    auto limb = [&](size_t i) -> uint32_t {
+        if (i >= n) {
+            return i == n && a.is_negative && lowest == n;
+        }
+        if (!a.is_negative) {
+            return p[i];
+        }
+        return i > lowest ? ~p[i] : i == lowest ? 0 - p[i] : 0;
+    };
+    shift = 0;
+    size_t top = n + 1;
+    while (top > 0 && limb(top - 1) == 0) {
+        top--;
+    }
+    if (top == 0) {
+        return 0;
+    }
+    size_t bits = (top - 1) * block;
+    for (uint32_t x = limb(top - 1); x != 0; x >>= 1) {
+        bits++;
+    }
+    size_t digits = std::numeric_limits<F>::digits;
+    size_t low = bits > digits ? bits - digits : 0;
+    F m = 0;
+    for (size_t i = top; i > low / block + 1; i--) {
+        m = std::ldexp(m, block) + limb(i - 1);
+    }
+    m = std::ldexp(m, block - low % block) + (limb(low / block) >> low % block);
+    if (low > 0) {
+        size_t r = low - 1;
+        bool half = (limb(r / block) >> r % block & 1) != 0;
+        bool sticky = (limb(r / block) & ((uint32_t(1) << r % block) - 1)) != 0 || lowest < r / block;
+        bool odd = (limb(low / block) >> low % block & 1) != 0;
+        if (half && (sticky || odd)) {
+            m += 1;
+        }
+    }
+    shift = static_cast<long>(low);
+    return m;
+}
+
+double to_double(big_integer const& a) {
+    long shift;
+    double m = big_integer::round_to_float<double>(a, shift);
+    m = std::ldexp(m, static_cast<int>(std::min<long>(shift, std::numeric_limits<int>::max())));
+    return a.is_negative ? -m : m;
+}
+
+long double to_long_double(big_integer const& a) {
+    long shift;
+    long double m = big_integer::round_to_float<long double>(a, shift);
+    m = std::ldexp(m, static_cast<int>(std::min<long>(shift, std::numeric_limits<int>::max())));
+    return a.is_negative ? -m : m;
+}
+
+double frexp(big_integer const& a, long* exponent) {
+    long shift;
+    int e;
+    double m = std::frexp(big_integer::round_to_float<double>(a, shift), &e);
+    *exponent = shift + e;
+    return a.is_negative ? -m : m;
+}
+
+// |a| = beta^n - number for a negative a: its top limb is ~top when any limb below is nonzero,
+// otherwise -top, or a single 1 above all n limbs when top is zero too
+size_t bit_length(big_integer const& a) {
+    size_t n = a.number.size();
+    uint32_t top = a.number[n - 1];
+    if (a.is_negative) {
+        if (!limbs_zero(a.number.data(), n - 1)) {
+            top = ~top;
+        } else if (top != 0) {
+            top = 0 - top;
+        } else {
+            return n * block + 1;
+        }
+    }
+    size_t bits = (n - 1) * block;
+    for (; top != 0; top >>= 1) {
+        bits++;
+    }
+    return bits;
+}
+
+namespace {
+    // the leaves of the decimal conversion are below 10^(9 * leaf_blocks) and go through division
+    // of a few limbs by 10^9
+    size_t static constexpr leaf_blocks = 16;
+    // subtrees with at least this many digits are split between two threads
+    size_t static constexpr parallel_digits = 1 << 15;
+    // up to this many limbs the repeated division by 10^9 is faster than the divide and conquer
+    size_t static constexpr quadratic_decimal_limbs = 64;
+
+    // divisors[k] is 10^digits[k] for digits[k] = 9 * leaf_blocks * 2^k
+    struct decimal_powers {
+        std::vector<big_divisor> divisors;
+        std::vector<size_t> digits;
+        unsigned threads;
+    };
+
+    // the digits of the magnitude in limbs[0, n) right-aligned at end in blocks of 9, so with up to
+    // 8 leading zeros; the limbs are overwritten. Returns the first digit
+    char* write_blocks(uint32_t* limbs, size_t n, char* end) {
+        char* p = end;
+        while (n > 0 && limbs[n - 1] == 0) {
+            n--;
+        }
+        while (n > 0) {
+            uint32_t rest = limbs_divmod_1(limbs, limbs, n, billion);
+            while (n > 0 && limbs[n - 1] == 0) {
+                n--;
+            }
+            for (size_t i = 0; i < len; i++) {
+                *--p = static_cast<char>('0' + rest % 10);
+                rest /= 10;
+            }
+        }
+        return p;
+    }
+
+    // the digits of 0 <= a < 10^(9 * leaf_blocks) right-aligned at end, all of them when padded and
+    // without leading zeros otherwise. Returns the first digit
+    char* write_leaf(big_integer const& a, char* end, bool padded) {
+        uint32_t limbs[leaf_blocks];
+        for (size_t i = 0; i < leaf_blocks; i++) {
+            limbs[i] = a[i];
+        }
+        char* p = write_blocks(limbs, leaf_blocks, end);
+        if (padded) {
+            std::fill(end - len * leaf_blocks, p, '0');
+            return end - len * leaf_blocks;
+        }
+        while (*p == '0') {
+            p++;
+        }
+        return p;
+    }
+
+    bool split(decimal_powers const& powers, size_t k, unsigned depth) {
+        return powers.digits[k] >= parallel_digits && (1u << depth) < powers.threads;
+    }
+
+    // exactly digits[k] digits of 0 <= a < 10^digits[k] at out, the two halves of every level on
+    // their own threads while there are threads for them
+    void write_padded(big_integer const& a, decimal_powers const& powers, size_t k, char* out, unsigned depth) {
+        if (k == 0) {
+            write_leaf(a, out + powers.digits[0], true);
+            return;
+        }
+        std::pair<big_integer, big_integer> qr = divmod(a, powers.divisors[k - 1]);
+        char* middle = out + powers.digits[k - 1];
+        if (split(powers, k, depth)) {
+            std::future<void> high = std::async(std::launch::async, write_padded, std::cref(qr.first),
+                                                std::cref(powers), k - 1, out, depth + 1);
+            write_padded(qr.second, powers, k - 1, middle, depth + 1);
+            high.get();
+        } else {
+            write_padded(qr.first, powers, k - 1, out, depth);
+            write_padded(qr.second, powers, k - 1, middle, depth);
+        }
+    }
+
+    // the digits of a > 0 without leading zeros right-aligned at end; returns the first one
+    char* write_top(big_integer const& a, decimal_powers const& powers, char* end, unsigned depth) {
+        size_t k = powers.divisors.size();
+        while (k > 0 && a < powers.divisors[k - 1].value()) {
+            k--;
+        }
+        if (k == 0) {
+            return write_leaf(a, end, false);
+        }
+        k--;
+        std::pair<big_integer, big_integer> qr = divmod(a, powers.divisors[k]);
+        char* middle = end - powers.digits[k];
+        if (split(powers, k, depth)) {
+            std::future<void> low = std::async(std::launch::async, write_padded, std::cref(qr.second),
+                                               std::cref(powers), k, middle, depth + 1);
+            char* begin = write_top(qr.first, powers, middle, depth + 1);
+            low.get();
+            return begin;
+        }
+        write_padded(qr.second, powers, k, middle, depth);
+        return write_top(qr.first, powers, middle, depth);
+    }
+}
+
+// Divide and conquer on the powers 10^(9 * leaf_blocks * 2^k): the quotient and the remainder by
+// a power go to the digits above and below its offset in one preallocated string, so no digits
+// are copied or padded afterwards, and the divisions are Barrett ones for long powers
+std::string big_integer_detail::to_string(big_integer const& a, unsigned threads) {
+    if (a == zero) {
+        return "0";
+    }
+    static big_integer const leaf_power = [] {
+        big_integer p = 1;
+        for (size_t i = 0; i < leaf_blocks; i++) {
+            p *= billion;
+        }
+        return p;
+    }();
+    big_integer x = a;
+    x.abs();
+    size_t bits = bit_length(x);
+    decimal_powers powers;
+    powers.threads = std::max(threads, 1u);
+    big_integer power = leaf_power;
+    for (size_t digits = len * leaf_blocks; bit_length(power) <= bits; digits *= 2) {
+        powers.divisors.emplace_back(power);
+        powers.digits.push_back(digits);
+        if (2 * bit_length(power) - 1 > bits) {
+            break;
+        }
+        power *= power;
+    }
+    // log10(2) < 0.30103, room for the leading zeros of the top block and the sign
+    std::string result(bits * 30103 / 100000 + len + 2, '0');
+    char* end = &result[0] + result.size();
+    char* begin = write_top(x, powers, end, 0);
+    if (a < zero) {
+        *--begin = '-';
+    }
+    result.erase(0, static_cast<size_t>(begin - &result[0]));
+    return result;
+}
+
+std::string to_string(big_integer const& a) {
+    static unsigned const threads = std::max(std::thread::hardware_concurrency(), 1u);
+    return big_integer_detail::to_string(a, threads);
+}
+
+big_workspace::big_workspace() = default;
+
+void big_workspace::mul(big_integer& r, big_integer const& a, big_integer const& b) {
+    big_integer::mul_to(r, a, b, operands, product);
+}
+
+void big_workspace::divmod(big_integer& q, big_integer& r, big_integer const& a, big_integer const& b) {
+    big_integer::divide_to(&q, &r, a, b, buffer, product);
+}
+
+void big_workspace::div(big_integer& q, big_integer const& a, big_integer const& b) {
+    big_integer::divide_to(&q, nullptr, a, b, buffer, product);
+}
+
+void big_workspace::mod(big_integer& r, big_integer const& a, big_integer const& b) {
+    big_integer::divide_to(nullptr, &r, a, b, buffer, product);
+}
+
+void big_workspace::divmod(big_integer& q, big_integer& r, big_integer const& a, big_divisor const& d) {
+    d.divide_to(&q, &r, a, operands, product, buffer);
 }
 
-big_integer big_integer::long_divide(big_integer& a, big_integer& b) {
-    auto last = static_cast<uint64_t>(b.number.back());
-    auto f = static_cast<uint32_t>((base / (last + 1)));
+void big_workspace::div(big_integer& q, big_integer const& a, big_divisor const& d) {
+    d.divide_to(&q, nullptr, a, operands, product, buffer);
+}
+
+void big_workspace::mod(big_integer& r, big_integer const& a, big_divisor const& d) {
+    d.divide_to(nullptr, &r, a, operands, product, buffer);
+}
+
+// repeated division by 10^9 in the limbs of the workspace, as long as it beats the divide and conquer
+void big_workspace::to_string(std::string& s, big_integer const& a) {
     size_t n = a.number.size();
-    size_t m = b.number.size();
-    std::vector<uint32_t> result(n - m + 1);
-    std::vector<uint32_t> buffer(m + 1);
-    std::vector<uint32_t> dq(m + 1, 0);
-    big_integer new_a = a;
-    big_integer new_b = b;
-    product(new_a.number, new_a.number, f);
-    product(new_b.number, new_b.number, f);
-    min_length(new_a);
-    min_length(new_b);
-    for (size_t i = 0; i <= m; i++) {
-        buffer[i] = new_a[n + i - m];
-    }
-    for (size_t i = n - m + 1; i > 0; i--) {
-        buffer[0] = new_a[i - 1];
-        uint32_t qt = trial(buffer, new_b.number.back());
-        product(dq, new_b.number, qt);
-        while (qt >= 0 && smaller(buffer, dq)) {
-            qt--;
-            product(dq, new_b.number, qt);
-        }
-        difference(buffer, dq);
-        shift(buffer);
-        result[i - 1] = qt;
-    }
-    a.number = result;
-    min_length(a);
-    big_integer remainder(0);
-    for (size_t i = 1; i < buffer.size(); i++) {
-        buffer[i - 1] = buffer[i];
-    }
-    buffer.pop_back();
-    remainder.number = buffer;
-    min_length(remainder);
-    divide_short(remainder, f);
-    return remainder;
+    if (n > quadratic_decimal_limbs) {
+        s = ::to_string(a);
+        return;
+    }
+    buffer.resize(n + 1);
+    uint32_t const* pa = big_integer::magnitude(a, buffer.data(), n);
+    if (pa != buffer.data()) {
+        std::copy(pa, pa + n, buffer.data());
+    }
+    s.resize(n * block * 30103 / 100000 + len + 2);
+    char* end = &s[0] + s.size();
+    char* begin = write_blocks(buffer.data(), n, end);
+    while (begin != end && *begin == '0') {
+        begin++;
+    }
+    if (begin == end) {
+        *--begin = '0';
+    }
+    if (a.is_negative) {
+        *--begin = '-';
+    }
+    s.erase(0, static_cast<size_t>(begin - &s[0]));
+}
+
+std::ostream& operator<<(std::ostream& s, big_integer const& a) {
+    return s << to_string(a);
+}
+
+uint32_t big_integer::get_mask() {
+    return this->is_negative ? static_cast<uint32_t>(base - 1) : 0;
+}
+
+uint32_t big_integer::get_mask() const {
+    return this->is_negative ? static_cast<uint32_t>(base - 1) : 0;
+}
+
+void big_integer::min_length(big_integer& a) {
+    uint32_t mask = a.get_mask();
+    while (a.number.size() > 1 && a.number[a.number.size() - 1] == mask) {
+        a.number.pop_back();
+    }
+}
+
+void big_integer::resize(big_integer& a, size_t sz) {
+    uint32_t mask = a.get_mask();
+    size_t n = sz - a.number.size();
+    while (n > 0) {
+        a.number.push_back(mask);
+        n--;
+    }
+}
+
+void big_integer::bin_operator(big_integer const& rhs, limbs_operator op, uint32_t (*f)(uint32_t, uint32_t)) {
+    size_t n = std::max(number.size(), rhs.number.size());
+    size_t common = std::min(number.size(), rhs.number.size());
+    big_integer::resize(*this, n);
+    op(number.data(), number.data(), rhs.number.data(), common);
+    for (size_t i = common; i < n; i++) {
+        number[i] = f(number[i], rhs[i]);
+    }
+    is_negative = f(is_negative, rhs.is_negative);
+    min_length(*this);
 }
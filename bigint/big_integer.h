@@ -2,9 +2,15 @@
 
 #include <functional>
 #include <iosfwd>
+#include <random>
+#include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "big_integer_limbs.h"
+#include "big_integer_stats.h"
+
 struct big_integer
 {
     big_integer();
@@ -16,9 +22,20 @@ struct big_integer
     big_integer(unsigned int a);
     big_integer(int a);
     explicit big_integer(std::string const& str);
+    // truncated toward zero like a cast to an integer type, std::invalid_argument for infinities and NaN
+    explicit big_integer(double a);
+    explicit big_integer(long double a);
+    static big_integer from_limbs(uint32_t const* magnitude, size_t n, bool negative);
+
+    // uniform in [0, 2^bits) and in [0, bound) for a positive bound, limbs drawn straight from rng
+    template <typename URBG>
+    static big_integer random_bits(size_t bits, URBG&& rng);
+    template <typename URBG>
+    static big_integer random_below(big_integer const& bound, URBG&& rng);
+
     ~big_integer() = default;
 
-    big_integer& operator=(big_integer const& other) = default;
+    big_integer& operator=(big_integer const& other);
 
     big_integer& operator+=(big_integer const& rhs);
     big_integer& operator-=(big_integer const& rhs);
@@ -56,24 +73,129 @@ struct big_integer
     friend bool operator>=(big_integer const& a, big_integer const& b);
 
     friend std::string to_string(big_integer const& a);
+    friend double to_double(big_integer const& a);
+    friend long double to_long_double(big_integer const& a);
+    friend double frexp(big_integer const& a, long* exponent);
+    friend size_t bit_length(big_integer const& a);
+
+    friend void add_n(big_integer* r, big_integer const* a, big_integer const* b, size_t n);
+    friend void sub_n(big_integer* r, big_integer const* a, big_integer const* b, size_t n);
+    friend void mul_n(big_integer* r, big_integer const* a, big_integer const* b, size_t n);
+
+    friend big_integer product(big_integer const* first, size_t n);
+    friend big_integer sum(big_integer const* first, size_t n);
+    friend big_integer factorial(unsigned n);
+    friend big_integer binomial(unsigned n, unsigned k);
+
+    friend big_integer divexact(big_integer const& a, big_integer const& b);
+    friend bool divisible_by(big_integer const& a, big_integer const& b);
+
+    friend big_integer pow_mod(big_integer const& base, big_integer const& exponent, big_integer const& modulus);
+    friend bool is_probable_prime(big_integer const& a);
+    friend big_integer next_prime(big_integer const& a);
+
+    friend std::pair<big_integer, big_integer> divmod(big_integer const& a, big_integer const& b);
+    friend std::pair<big_integer, big_integer> divmod_floor(big_integer const& a, big_integer const& b);
 
     void abs();
 
 private:
+    friend struct big_accumulator;
+    friend struct std::hash<big_integer>;
+    friend struct big_divisor;
+    friend struct big_workspace;
+    friend struct mod_context;
+    friend struct residue;
+    using limb_vector = big_integer_detail::shared_limbs;
+
     void fill_number(uint64_t a);
-    void bin_operator(big_integer const& b, const std::function<uint32_t (uint32_t, uint32_t)>& f);
+    template <typename F>
+    void fill_float(F a);
+    template <typename F>
+    static F round_to_float(big_integer const& a, long& shift);
+    using limbs_operator = void (*)(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n);
+    void bin_operator(big_integer const& b, limbs_operator op, uint32_t (*f)(uint32_t, uint32_t));
     static void resize(big_integer& a, size_t sz);
     static void min_length(big_integer& a);
-    static big_integer divide(big_integer& a, big_integer& b);
-    static big_integer long_divide(big_integer& a, big_integer& b);
+    static void add_to(big_integer& r, big_integer const& a, big_integer const& b, bool subtract);
+    static void add_to_n(big_integer* r, big_integer const* a, big_integer const* b, size_t n, bool subtract);
+    static void mul_to(big_integer& r, big_integer const& a, big_integer const& b,
+                       limb_vector& operands, limb_vector& product);
+    static big_integer product_tree(std::vector<big_integer>& factors);
+    static void push_factors(std::vector<big_integer>& factors, unsigned first, unsigned last, size_t& twos);
+    static uint32_t const* magnitude(big_integer const& a, uint32_t* buffer, size_t& n);
+    static bool hensel_operands(big_integer const& a, big_integer const& b,
+                                limb_vector& na, limb_vector& nb);
+    static void divide_to(big_integer* q, big_integer* r, big_integer const& a, big_integer const& b);
+    static void divide_to(big_integer* q, big_integer* r, big_integer const& a, big_integer const& b,
+                          limb_vector& buffer, limb_vector& quotient);
     static big_integer invert_add(big_integer tmp, uint64_t carry);
-    static uint32_t divide_short(big_integer& a, uint32_t b);
     uint32_t get_mask();
     uint32_t get_mask() const;
+    template <typename URBG>
+    static void fill_random(uint32_t* limbs, size_t n, URBG& rng);
     bool is_negative;
-    std::vector<uint32_t> number;
+    limb_vector number;
 };
 
+template <typename URBG>
+void big_integer::fill_random(uint32_t* limbs, size_t n, URBG& rng) {
+    std::uniform_int_distribution<uint32_t> limb;
+    for (size_t i = 0; i < n; i++) {
+        limbs[i] = limb(rng);
+    }
+}
+
+template <typename URBG>
+big_integer big_integer::random_bits(size_t bits, URBG&& rng) {
+    big_integer result;
+    size_t n = (bits + 31) / 32;
+    if (n == 0) {
+        return result;
+    }
+    result.number.assign(n + 1, 0);
+    fill_random(result.number.data(), n, rng);
+    if (bits % 32 != 0) {
+        result.number[n - 1] &= (uint32_t(1) << bits % 32) - 1;
+    }
+    min_length(result);
+    return result;
+}
+
+// rejection sampling on the bit length of bound: on average less than two draws
+template <typename URBG>
+big_integer big_integer::random_below(big_integer const& bound, URBG&& rng) {
+    if (bound.is_negative || bound == 0) {
+        throw std::invalid_argument("random_below: bound must be positive");
+    }
+    size_t n = bound.number.size();
+    while (bound.number[n - 1] == 0) {
+        n--;
+    }
+    uint32_t mask = bound.number[n - 1];
+    for (unsigned shift = 1; shift < 32; shift *= 2) {
+        mask |= mask >> shift;
+    }
+    big_integer result;
+    do {
+        result.number.assign(n + 1, 0);
+        fill_random(result.number.data(), n, rng);
+        result.number[n - 1] &= mask;
+        min_length(result);
+    } while (result >= bound);
+    return result;
+}
+
+namespace std
+{
+    // consistent with operator==, so big_integer can key unordered containers
+    template <>
+    struct hash<big_integer>
+    {
+        size_t operator()(big_integer const& a) const noexcept;
+    };
+}
+
 big_integer operator+(big_integer a, big_integer const& b);
 big_integer operator-(big_integer a, big_integer const& b);
 big_integer operator*(big_integer a, big_integer const& b);
@@ -94,5 +216,44 @@ bool operator>(big_integer const& a, big_integer const& b);
 bool operator<=(big_integer const& a, big_integer const& b);
 bool operator>=(big_integer const& a, big_integer const& b);
 
+// element-wise r[i] = a[i] op b[i] for i in [0, n); r may alias a or b,
+// and reusing the same r between batches avoids reallocating its limbs.
+// Numbers of up to eight limbs are added eight pairs at a time, limb position by limb position
+void add_n(big_integer* r, big_integer const* a, big_integer const* b, size_t n);
+void sub_n(big_integer* r, big_integer const* a, big_integer const* b, size_t n);
+void mul_n(big_integer* r, big_integer const* a, big_integer const* b, size_t n);
+
+// product and sum of [first, first + n); the product multiplies operands of similar size first
+big_integer product(big_integer const* first, size_t n);
+big_integer sum(big_integer const* first, size_t n);
+big_integer factorial(unsigned n);
+big_integer binomial(unsigned n, unsigned k);
+
+// a / b for b dividing a exactly, otherwise the result is unspecified
+big_integer divexact(big_integer const& a, big_integer const& b);
+bool divisible_by(big_integer const& a, big_integer const& b);
+
+// {quotient, remainder} from a single division, rounding toward zero or toward minus infinity
+std::pair<big_integer, big_integer> divmod(big_integer const& a, big_integer const& b);
+std::pair<big_integer, big_integer> divmod_floor(big_integer const& a, big_integer const& b);
+
+// base^exponent mod modulus in [0, modulus) for a positive modulus and exponent >= 0,
+// in Montgomery form when the modulus is odd
+big_integer pow_mod(big_integer const& base, big_integer const& exponent, big_integer const& modulus);
+// Baillie-PSW after trial division by the primes below 1000: exact below 2^64,
+// no composite passing it is known above
+bool is_probable_prime(big_integer const& a);
+// the smallest probable prime greater than a
+big_integer next_prime(big_integer const& a);
+
+// the nearest value, ties to even, infinite beyond the largest finite one; only the top limbs are read
+double to_double(big_integer const& a);
+long double to_long_double(big_integer const& a);
+// a = m * 2^exponent with |m| in [0.5, 1) rounded like to_double, so it never overflows; 0 for zero
+double frexp(big_integer const& a, long* exponent);
+// the number of bits of |a|, 0 for zero
+size_t bit_length(big_integer const& a);
+
 std::string to_string(big_integer const& a);
 std::ostream& operator<<(std::ostream& s, big_integer const& a);
+
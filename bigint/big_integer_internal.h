@@ -0,0 +1,13 @@
+#pragma once
+
+#include <string>
+
+struct big_integer;
+
+// Entry points of big_integer.cpp with their tuning made explicit, for the tests; the public
+// functions in big_integer.h call them with the values for the current machine.
+namespace big_integer_detail
+{
+    // to_string(a) splitting the conversion of long numbers between up to threads threads
+    std::string to_string(big_integer const& a, unsigned threads);
+}
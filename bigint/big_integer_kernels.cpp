@@ -0,0 +1,418 @@
+#include "big_integer_kernels.h"
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define BIG_INTEGER_X86_KERNELS
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+#if defined(BIG_INTEGER_ASM_KERNELS) && defined(BIG_INTEGER_X86_KERNELS)
+#include "../asm/limbs.h"
+#else
+#undef BIG_INTEGER_ASM_KERNELS
+#endif
+
+namespace {
+    unsigned static constexpr block = 32;
+
+    uint32_t add_n(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {
+        uint64_t carry = 0;
+        for (size_t i = 0; i < n; i++) {
+            carry += static_cast<uint64_t>(a[i]) + b[i];
+            r[i] = static_cast<uint32_t>(carry);
+            carry >>= block;
+        }
+        return static_cast<uint32_t>(carry);
+    }
+
+    uint32_t sub_n(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {
+        uint64_t borrow = 0;
+        for (size_t i = 0; i < n; i++) {
+            uint64_t res = static_cast<uint64_t>(a[i]) - b[i] - borrow;
+            r[i] = static_cast<uint32_t>(res);
+            borrow = res >> (2 * block - 1);
+        }
+        return static_cast<uint32_t>(borrow);
+    }
+
+    uint32_t mul_1(uint32_t* r, uint32_t const* a, size_t n, uint32_t b) {
+        uint64_t carry = 0;
+        for (size_t i = 0; i < n; i++) {
+            carry += static_cast<uint64_t>(a[i]) * b;
+            r[i] = static_cast<uint32_t>(carry);
+            carry >>= block;
+        }
+        return static_cast<uint32_t>(carry);
+    }
+
+    uint32_t addmul_1(uint32_t* r, uint32_t const* a, size_t n, uint32_t b) {
+        uint64_t carry = 0;
+        for (size_t i = 0; i < n; i++) {
+            carry += static_cast<uint64_t>(a[i]) * b + r[i];
+            r[i] = static_cast<uint32_t>(carry);
+            carry >>= block;
+        }
+        return static_cast<uint32_t>(carry);
+    }
+
+    uint32_t submul_1(uint32_t* r, uint32_t const* a, size_t n, uint32_t b) {
+        uint64_t carry = 0;
+        for (size_t i = 0; i < n; i++) {
+            carry += static_cast<uint64_t>(a[i]) * b;
+            auto low = static_cast<uint32_t>(carry);
+            carry >>= block;
+            carry += r[i] < low;
+            r[i] -= low;
+        }
+        return static_cast<uint32_t>(carry);
+    }
+
+    uint32_t lshift(uint32_t* r, uint32_t const* a, size_t n, unsigned count) {
+        uint32_t out = a[n - 1] >> (block - count);
+        for (size_t i = n - 1; i > 0; i--) {
+            r[i] = (a[i] << count) | (a[i - 1] >> (block - count));
+        }
+        r[0] = a[0] << count;
+        return out;
+    }
+
+    void rshift(uint32_t* r, uint32_t const* a, size_t n, unsigned count) {
+        for (size_t i = 0; i + 1 < n; i++) {
+            r[i] = (a[i] >> count) | (a[i + 1] << (block - count));
+        }
+        r[n - 1] = a[n - 1] >> count;
+    }
+
+    void and_n(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            r[i] = a[i] & b[i];
+        }
+    }
+
+    void or_n(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            r[i] = a[i] | b[i];
+        }
+    }
+
+    void xor_n(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            r[i] = a[i] ^ b[i];
+        }
+    }
+
+    void add_lanes(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t rows, uint32_t carry) {
+        uint64_t carries[8];
+        std::fill(carries, carries + 8, carry);
+        for (size_t i = 0; i < 8 * rows; i += 8) {
+            for (size_t l = 0; l < 8; l++) {
+                carries[l] += static_cast<uint64_t>(a[i + l]) + b[i + l];
+                r[i + l] = static_cast<uint32_t>(carries[l]);
+                carries[l] >>= block;
+            }
+        }
+    }
+
+    limb_kernels constexpr portable = {
+        "portable", add_n, sub_n, mul_1, addmul_1, submul_1, lshift, rshift, and_n, or_n, xor_n, add_lanes};
+
+#ifdef BIG_INTEGER_X86_KERNELS
+    // the x86 versions process two limbs at a time as one 64-bit word
+    __extension__ typedef unsigned __int128 uint128;
+
+    uint64_t load(uint32_t const* p) {
+        uint64_t word;
+        std::memcpy(&word, p, sizeof(word));
+        return word;
+    }
+
+    void store(uint32_t* p, uint64_t word) {
+        std::memcpy(p, &word, sizeof(word));
+    }
+
+    __attribute__((target("adx"))) uint32_t add_n_adx(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {
+        unsigned char carry = 0;
+        size_t i = 0;
+        for (; i + 2 <= n; i += 2) {
+            unsigned long long word;
+            carry = _addcarryx_u64(carry, load(a + i), load(b + i), &word);
+            store(r + i, word);
+        }
+        if (i < n) {
+            unsigned int limb;
+            carry = _addcarryx_u32(carry, a[i], b[i], &limb);
+            r[i] = limb;
+        }
+        return carry;
+    }
+
+    __attribute__((target("adx"))) uint32_t sub_n_adx(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {
+        unsigned char borrow = 0;
+        size_t i = 0;
+        for (; i + 2 <= n; i += 2) {
+            unsigned long long word;
+            borrow = _subborrow_u64(borrow, load(a + i), load(b + i), &word);
+            store(r + i, word);
+        }
+        if (i < n) {
+            unsigned int limb;
+            borrow = _subborrow_u32(borrow, a[i], b[i], &limb);
+            r[i] = limb;
+        }
+        return borrow;
+    }
+
+    // with bmi2 the compiler multiplies with mulx, which leaves the flags of the carry chain alone
+    __attribute__((target("bmi2"))) uint32_t mul_1_bmi2(uint32_t* r, uint32_t const* a, size_t n, uint32_t b) {
+        uint128 carry = 0;
+        size_t i = 0;
+        for (; i + 2 <= n; i += 2) {
+            carry += static_cast<uint128>(load(a + i)) * b;
+            store(r + i, static_cast<uint64_t>(carry));
+            carry >>= 2 * block;
+        }
+        // the product of the limbs so far fits, so the carry is below 2^32
+        uint64_t rest = static_cast<uint64_t>(carry);
+        if (i < n) {
+            rest += static_cast<uint64_t>(a[i]) * b;
+            r[i] = static_cast<uint32_t>(rest);
+            rest >>= block;
+        }
+        return static_cast<uint32_t>(rest);
+    }
+
+    __attribute__((target("bmi2"))) uint32_t addmul_1_bmi2(uint32_t* r, uint32_t const* a, size_t n, uint32_t b) {
+        uint128 carry = 0;
+        size_t i = 0;
+        for (; i + 2 <= n; i += 2) {
+            carry += static_cast<uint128>(load(a + i)) * b + load(r + i);
+            store(r + i, static_cast<uint64_t>(carry));
+            carry >>= 2 * block;
+        }
+        uint64_t rest = static_cast<uint64_t>(carry);
+        if (i < n) {
+            rest += static_cast<uint64_t>(a[i]) * b + r[i];
+            r[i] = static_cast<uint32_t>(rest);
+            rest >>= block;
+        }
+        return static_cast<uint32_t>(rest);
+    }
+
+    __attribute__((target("bmi2"))) uint32_t submul_1_bmi2(uint32_t* r, uint32_t const* a, size_t n, uint32_t b) {
+        uint128 carry = 0;
+        size_t i = 0;
+        for (; i + 2 <= n; i += 2) {
+            carry += static_cast<uint128>(load(a + i)) * b;
+            auto low = static_cast<uint64_t>(carry);
+            uint64_t word = load(r + i);
+            carry >>= 2 * block;
+            carry += word < low;
+            store(r + i, word - low);
+        }
+        uint64_t rest = static_cast<uint64_t>(carry);
+        if (i < n) {
+            rest += static_cast<uint64_t>(a[i]) * b;
+            auto low = static_cast<uint32_t>(rest);
+            rest >>= block;
+            rest += r[i] < low;
+            r[i] -= low;
+        }
+        return static_cast<uint32_t>(rest);
+    }
+
+    __attribute__((target("bmi2"))) uint32_t lshift_bmi2(uint32_t* r, uint32_t const* a, size_t n, unsigned count) {
+        uint32_t out = a[n - 1] >> (block - count);
+        size_t i = n - 1;
+        for (; i >= 2; i -= 2) {
+            store(r + i - 1, (load(a + i - 1) << count) | (a[i - 2] >> (block - count)));
+        }
+        if (i == 1) {
+            r[1] = (a[1] << count) | (a[0] >> (block - count));
+        }
+        r[0] = a[0] << count;
+        return out;
+    }
+
+    __attribute__((target("bmi2"))) void rshift_bmi2(uint32_t* r, uint32_t const* a, size_t n, unsigned count) {
+        size_t i = 0;
+        for (; i + 2 < n; i += 2) {
+            store(r + i, (load(a + i) >> count) | (static_cast<uint64_t>(a[i + 2]) << (2 * block - count)));
+        }
+        for (; i + 1 < n; i++) {
+            r[i] = (a[i] >> count) | (a[i + 1] << (block - count));
+        }
+        r[n - 1] = a[n - 1] >> count;
+    }
+
+    __attribute__((target("avx2"))) void and_n_avx2(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(a + i));
+            __m256i y = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(b + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(r + i), _mm256_and_si256(x, y));
+        }
+        and_n(r + i, a + i, b + i, n - i);
+    }
+
+    __attribute__((target("avx2"))) void or_n_avx2(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(a + i));
+            __m256i y = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(b + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(r + i), _mm256_or_si256(x, y));
+        }
+        or_n(r + i, a + i, b + i, n - i);
+    }
+
+    __attribute__((target("avx2"))) void xor_n_avx2(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(a + i));
+            __m256i y = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(b + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(r + i), _mm256_xor_si256(x, y));
+        }
+        xor_n(r + i, a + i, b + i, n - i);
+    }
+
+    // a row of eight lanes is one register; the carry out of s = x + y + c is the top bit of
+    // (x & y) | ((x | y) & ~s), so the lanes need no 64-bit widening
+    __attribute__((target("avx2"))) void add_lanes_avx2(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t rows,
+                                                        uint32_t carry) {
+        __m256i c = _mm256_set1_epi32(static_cast<int>(carry));
+        for (size_t i = 0; i < 8 * rows; i += 8) {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(a + i));
+            __m256i y = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(b + i));
+            __m256i sum = _mm256_add_epi32(_mm256_add_epi32(x, y), c);
+            __m256i out = _mm256_or_si256(_mm256_and_si256(x, y), _mm256_andnot_si256(sum, _mm256_or_si256(x, y)));
+            c = _mm256_srli_epi32(out, block - 1);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(r + i), sum);
+        }
+    }
+
+    __attribute__((target("avx512f"))) void and_n_avx512(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {
+        size_t i = 0;
+        for (; i + 16 <= n; i += 16) {
+            _mm512_storeu_si512(r + i, _mm512_and_si512(_mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i)));
+        }
+        and_n(r + i, a + i, b + i, n - i);
+    }
+
+    __attribute__((target("avx512f"))) void or_n_avx512(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {
+        size_t i = 0;
+        for (; i + 16 <= n; i += 16) {
+            _mm512_storeu_si512(r + i, _mm512_or_si512(_mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i)));
+        }
+        or_n(r + i, a + i, b + i, n - i);
+    }
+
+    __attribute__((target("avx512f"))) void xor_n_avx512(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {
+        size_t i = 0;
+        for (; i + 16 <= n; i += 16) {
+            _mm512_storeu_si512(r + i, _mm512_xor_si512(_mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i)));
+        }
+        xor_n(r + i, a + i, b + i, n - i);
+    }
+
+    struct cpu_features
+    {
+        bool bmi2_adx = false;
+        bool avx2 = false;
+        bool avx512 = false;
+    };
+
+    // vector registers also need operating system support, which xgetbv reports
+    cpu_features detect() {
+        cpu_features features;
+        unsigned eax, ebx, ecx, edx;
+        if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) == 0) {
+            return features;
+        }
+        uint64_t xcr0 = 0;
+        if ((ecx >> 27 & 1) != 0) {
+            uint32_t low, high;
+            __asm__("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+            xcr0 = (static_cast<uint64_t>(high) << block) | low;
+        }
+        bool avx = (ecx >> 28 & 1) != 0 && (xcr0 & 0x06) == 0x06;
+        if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) == 0) {
+            return features;
+        }
+        features.bmi2_adx = (ebx >> 8 & 1) != 0 && (ebx >> 19 & 1) != 0;
+        features.avx2 = avx && (ebx >> 5 & 1) != 0;
+        features.avx512 = features.avx2 && (xcr0 & 0xe6) == 0xe6 && (ebx >> 16 & 1) != 0;
+        return features;
+    }
+
+    limb_kernels constexpr bmi2_adx = {
+        "bmi2-adx", add_n_adx, sub_n_adx, mul_1_bmi2, addmul_1_bmi2, submul_1_bmi2,
+        lshift_bmi2, rshift_bmi2, and_n, or_n, xor_n, add_lanes};
+    limb_kernels constexpr avx2 = {
+        "avx2", add_n, sub_n, mul_1, addmul_1, submul_1, lshift, rshift, and_n_avx2, or_n_avx2, xor_n_avx2,
+        add_lanes_avx2};
+    // eight lanes fill only half a 512-bit register, so the lanes stay on AVX2
+    limb_kernels constexpr avx512 = {
+        "avx512", add_n, sub_n, mul_1, addmul_1, submul_1, lshift, rshift, and_n_avx512, or_n_avx512, xor_n_avx512,
+        add_lanes_avx2};
+
+#ifdef BIG_INTEGER_ASM_KERNELS
+    // asm/limbs.S needs nothing beyond x86-64, the shifts come from C++
+    limb_kernels constexpr assembly = {
+        "asm", limbs_asm_add_n, limbs_asm_sub_n, limbs_asm_mul_1, limbs_asm_addmul_1, limbs_asm_submul_1,
+        lshift, rshift, and_n, or_n, xor_n, add_lanes};
+#endif
+
+    cpu_features const features = detect();
+
+    bool select() {
+        static std::string name;
+        limb_kernels const& arithmetic = features.bmi2_adx ? bmi2_adx : portable;
+        limb_kernels const& bitwise = features.avx512 ? avx512 : features.avx2 ? avx2 : portable;
+        kernels = arithmetic;
+        name = arithmetic.name;
+#ifdef BIG_INTEGER_ASM_KERNELS
+        // the unrolled add/sub and multiplication rows measured faster than the compiled ones
+        kernels.add_n = assembly.add_n;
+        kernels.sub_n = assembly.sub_n;
+        kernels.mul_1 = assembly.mul_1;
+        kernels.addmul_1 = assembly.addmul_1;
+        kernels.submul_1 = assembly.submul_1;
+        name = features.bmi2_adx ? "asm+bmi2" : "asm";
+#endif
+        kernels.and_n = bitwise.and_n;
+        kernels.or_n = bitwise.or_n;
+        kernels.xor_n = bitwise.xor_n;
+        kernels.add_lanes = bitwise.add_lanes;
+        if (&bitwise != &portable) {
+            name = name + "+" + bitwise.name;
+        }
+        kernels.name = name.c_str();
+        return true;
+    }
+
+    bool const selected = select();
+#endif
+}
+
+limb_kernels kernels = portable;
+
+std::vector<limb_kernels> supported_kernels() {
+    std::vector<limb_kernels> result = {portable};
+#ifdef BIG_INTEGER_ASM_KERNELS
+    result.push_back(assembly);
+#endif
+#ifdef BIG_INTEGER_X86_KERNELS
+    if (features.bmi2_adx) {
+        result.push_back(bmi2_adx);
+    }
+    if (features.avx2) {
+        result.push_back(avx2);
+    }
+    if (features.avx512) {
+        result.push_back(avx512);
+    }
+#endif
+    return result;
+}
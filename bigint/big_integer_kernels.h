@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Inner loops of big_integer over little-endian arrays of 32-bit limbs.
+// Unless stated otherwise r may coincide with an operand but must not partially overlap it.
+struct limb_kernels
+{
+    char const* name;
+
+    // r = a + b, r = a - b; returns the carry (borrow) out of the top limb
+    uint32_t (*add_n)(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n);
+    uint32_t (*sub_n)(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n);
+
+    // r = a * b, r += a * b, r -= a * b; returns the top limb of the product (the borrow for submul_1)
+    uint32_t (*mul_1)(uint32_t* r, uint32_t const* a, size_t n, uint32_t b);
+    uint32_t (*addmul_1)(uint32_t* r, uint32_t const* a, size_t n, uint32_t b);
+    uint32_t (*submul_1)(uint32_t* r, uint32_t const* a, size_t n, uint32_t b);
+
+    // shifts by count in [1, 31]; lshift allows r above a and returns the bits shifted out,
+    // rshift allows r below a and fills the top with zeros
+    uint32_t (*lshift)(uint32_t* r, uint32_t const* a, size_t n, unsigned count);
+    void (*rshift)(uint32_t* r, uint32_t const* a, size_t n, unsigned count);
+
+    void (*and_n)(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n);
+    void (*or_n)(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n);
+    void (*xor_n)(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n);
+
+    // eight independent additions: a and b are rows limbs of eight numbers each, limb i of number l
+    // at index 8 * i + l, and every lane gets r = a + b + carry (carry 0 or 1) with its carry out
+    // dropped. r may coincide with a or b
+    void (*add_lanes)(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t rows, uint32_t carry);
+};
+
+// the fastest implementations this CPU supports, chosen once during static initialization;
+// until then (and on other architectures) the portable ones
+extern limb_kernels kernels;
+
+// every implementation set this CPU can run, the portable one first
+std::vector<limb_kernels> supported_kernels();
@@ -0,0 +1,225 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <utility>
+
+#include "big_integer_stats.h"
+
+namespace big_integer_detail
+{
+    // Limbs of a big_integer: a vector whose heap block is reference counted and shared between
+    // copies, like the dynamic_buffer of socow_vector. Copying is O(1); every non-const access makes
+    // the block unique first, so the limbs are copied only when one of the sharing values changes.
+    // The counter is atomic, so copies of one value may be made and read from several threads.
+    class shared_limbs
+    {
+    public:
+        shared_limbs() noexcept : block(nullptr), size_(0) {}
+
+        explicit shared_limbs(size_t n, uint32_t value = 0) : shared_limbs() {
+            assign(n, value);
+        }
+
+        shared_limbs(shared_limbs const& other) noexcept : block(other.block), size_(other.size_) {
+            if (block != nullptr) {
+                block->refs.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        shared_limbs(shared_limbs&& other) noexcept : block(other.block), size_(other.size_) {
+            other.block = nullptr;
+            other.size_ = 0;
+        }
+
+        shared_limbs& operator=(shared_limbs const& other) noexcept {
+            shared_limbs tmp(other);
+            swap(tmp);
+            return *this;
+        }
+
+        shared_limbs& operator=(shared_limbs&& other) noexcept {
+            shared_limbs tmp(std::move(other));
+            swap(tmp);
+            return *this;
+        }
+
+        ~shared_limbs() {
+            release(block);
+        }
+
+        void swap(shared_limbs& other) noexcept {
+            std::swap(block, other.block);
+            std::swap(size_, other.size_);
+        }
+
+        size_t size() const {
+            return size_;
+        }
+
+        bool empty() const {
+            return size_ == 0;
+        }
+
+        size_t capacity() const {
+            return block == nullptr ? 0 : block->capacity;
+        }
+
+        bool unique() const {
+            return block == nullptr || block->refs.load(std::memory_order_acquire) == 1;
+        }
+
+        uint32_t const* data() const {
+            return limbs();
+        }
+
+        uint32_t* data() {
+            make_unique(size_);
+            return limbs();
+        }
+
+        uint32_t const& operator[](size_t i) const {
+            return limbs()[i];
+        }
+
+        uint32_t& operator[](size_t i) {
+            return data()[i];
+        }
+
+        uint32_t const* begin() const {
+            return limbs();
+        }
+
+        uint32_t const* end() const {
+            return limbs() + size_;
+        }
+
+        uint32_t* begin() {
+            return data();
+        }
+
+        uint32_t* end() {
+            return data() + size_;
+        }
+
+        uint32_t const& back() const {
+            return limbs()[size_ - 1];
+        }
+
+        uint32_t& back() {
+            return data()[size_ - 1];
+        }
+
+        void reserve(size_t n) {
+            if (!unique() || n > capacity()) {
+                reallocate(std::max(n, size_));
+            }
+        }
+
+        void push_back(uint32_t value) {
+            make_unique(size_ + 1);
+            limbs()[size_++] = value;
+        }
+
+        void pop_back() {
+            make_unique(size_);
+            size_--;
+        }
+
+        void resize(size_t n, uint32_t value = 0) {
+            make_unique(n);
+            if (n > size_) {
+                std::fill(limbs() + size_, limbs() + n, value);
+            }
+            size_ = n;
+        }
+
+        // the old limbs are dropped, so a shared block is left to its other owners without copying
+        void assign(size_t n, uint32_t value) {
+            if (!unique() || n > capacity()) {
+                replace(n);
+            }
+            std::fill(limbs(), limbs() + n, value);
+            size_ = n;
+        }
+
+        void assign(uint32_t const* first, uint32_t const* last) {
+            auto n = static_cast<size_t>(last - first);
+            if (!unique() || n > capacity()) {
+                shared_limbs tmp;
+                tmp.replace(n);
+                std::copy(first, last, tmp.limbs());
+                tmp.size_ = n;
+                swap(tmp);
+                return;
+            }
+            std::memmove(limbs(), first, n * sizeof(uint32_t));
+            size_ = n;
+        }
+
+    private:
+        struct header
+        {
+            std::atomic<size_t> refs;
+            size_t capacity;
+        };
+
+        static header* allocate(size_t capacity) {
+            size_t bytes = sizeof(header) + capacity * sizeof(uint32_t);
+            count(counter::allocations);
+            count(counter::allocated_bytes, bytes);
+            auto* result = new (::operator new(bytes)) header;
+            result->refs.store(1, std::memory_order_relaxed);
+            result->capacity = capacity;
+            return result;
+        }
+
+        static void release(header* h) {
+            if (h != nullptr && h->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                h->~header();
+                ::operator delete(h);
+            }
+        }
+
+        uint32_t* limbs() const {
+            return block == nullptr ? nullptr : reinterpret_cast<uint32_t*>(block + 1);
+        }
+
+        // a block of its own with room for at least n limbs, keeping the current ones
+        void make_unique(size_t n) {
+            if (unique() && n <= capacity()) {
+                return;
+            }
+            reallocate(n <= capacity() ? capacity() : std::max(n, 2 * capacity()));
+        }
+
+        void reallocate(size_t capacity) {
+            header* fresh = allocate(capacity);
+            std::copy(limbs(), limbs() + std::min(size_, capacity), reinterpret_cast<uint32_t*>(fresh + 1));
+            release(block);
+            block = fresh;
+        }
+
+        // a block of its own for n limbs with unspecified contents
+        void replace(size_t n) {
+            header* fresh = allocate(n);
+            release(block);
+            block = fresh;
+        }
+
+        header* block;
+        size_t size_;
+
+        friend bool operator==(shared_limbs const& a, shared_limbs const& b) {
+            return a.size_ == b.size_ && (a.block == b.block || std::equal(a.begin(), a.end(), b.begin()));
+        }
+
+        friend bool operator!=(shared_limbs const& a, shared_limbs const& b) {
+            return !(a == b);
+        }
+    };
+}
@@ -0,0 +1,34 @@
+#include "big_integer_stats.h"
+#include <atomic>
+
+namespace {
+    std::atomic<uint64_t> counters[static_cast<size_t>(big_integer_detail::counter::size)];
+
+    uint64_t load(big_integer_detail::counter c) {
+        return counters[static_cast<size_t>(c)].load(std::memory_order_relaxed);
+    }
+}
+
+void big_integer_detail::add_to_counter(counter c, uint64_t n) {
+    counters[static_cast<size_t>(c)].fetch_add(n, std::memory_order_relaxed);
+}
+
+big_integer_stats get_big_integer_stats() {
+    using big_integer_detail::counter;
+    big_integer_stats stats;
+    stats.allocations = load(counter::allocations);
+    stats.allocated_bytes = load(counter::allocated_bytes);
+    stats.copies = load(counter::copies);
+    stats.invert_add_passes = load(counter::invert_add_passes);
+    stats.divisions = load(counter::divisions);
+    stats.long_divisions = load(counter::long_divisions);
+    stats.basecase_multiplications = load(counter::basecase_multiplications);
+    stats.karatsuba_multiplications = load(counter::karatsuba_multiplications);
+    return stats;
+}
+
+void reset_big_integer_stats() {
+    for (std::atomic<uint64_t>& c : counters) {
+        c.store(0, std::memory_order_relaxed);
+    }
+}
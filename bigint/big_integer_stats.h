@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// What big_integer has done since the start of the program or the last reset.
+// Counted only when every translation unit is built with BIG_INTEGER_STATS
+// (the ENABLE_STATS CMake option), otherwise all fields stay zero at no cost.
+struct big_integer_stats
+{
+    uint64_t allocations;
+    uint64_t allocated_bytes;
+    uint64_t copies;
+    uint64_t invert_add_passes;
+    uint64_t divisions;
+    uint64_t long_divisions;
+    uint64_t basecase_multiplications;
+    uint64_t karatsuba_multiplications;
+};
+
+big_integer_stats get_big_integer_stats();
+void reset_big_integer_stats();
+
+namespace big_integer_detail
+{
+    enum class counter
+    {
+        allocations,
+        allocated_bytes,
+        copies,
+        invert_add_passes,
+        divisions,
+        long_divisions,
+        basecase_multiplications,
+        karatsuba_multiplications,
+        size
+    };
+
+    void add_to_counter(counter c, uint64_t n);
+
+    inline void count(counter c, uint64_t n = 1) {
+#ifdef BIG_INTEGER_STATS
+        add_to_counter(c, n);
+#else
+        (void) c;
+        (void) n;
+#endif
+    }
+
+    template <typename T>
+    struct counting_allocator
+    {
+        using value_type = T;
+
+        counting_allocator() = default;
+
+        template <typename U>
+        counting_allocator(counting_allocator<U> const&) {}
+
+        T* allocate(size_t n) {
+            count(counter::allocations);
+            count(counter::allocated_bytes, n * sizeof(T));
+            return std::allocator<T>().allocate(n);
+        }
+
+        void deallocate(T* p, size_t n) {
+            std::allocator<T>().deallocate(p, n);
+        }
+    };
+
+    template <typename T, typename U>
+    bool operator==(counting_allocator<T> const&, counting_allocator<U> const&) {
+        return true;
+    }
+
+    template <typename T, typename U>
+    bool operator!=(counting_allocator<T> const&, counting_allocator<U> const&) {
+        return false;
+    }
+
+#ifdef BIG_INTEGER_STATS
+    using limb_allocator = counting_allocator<uint32_t>;
+#else
+    using limb_allocator = std::allocator<uint32_t>;
+#endif
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+// Algorithm crossover points in 32-bit limbs, consumed by big_integer.cpp. These are defaults:
+// the `tune` target measures them on the current machine into big_integer_tuned_thresholds.h
+// in the build directory, which takes precedence in CMake builds.
+
+#ifdef BIG_INTEGER_TUNED_THRESHOLDS
+#include "big_integer_tuned_thresholds.h"
+#endif
+
+#ifndef KARATSUBA_THRESHOLD
+#define KARATSUBA_THRESHOLD 32
+#endif
+
+#ifndef BARRETT_THRESHOLD
+#define BARRETT_THRESHOLD 160
+#endif
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "big_divisor.h"
+#include "big_integer.h"
+#include <string>
+
+// Scratch limbs for multiplication, division and conversion to decimal. The operations write into
+// the limbs their results already have and keep every temporary in the workspace, so a loop of
+// them stops allocating once the workspace and the results have grown to the largest operands:
+// the quotient and the product trade blocks with the workspace instead of getting new ones.
+// Results may alias the operands. A workspace is used by one thread at a time.
+struct big_workspace
+{
+    big_workspace();
+
+    // r = a * b
+    void mul(big_integer& r, big_integer const& a, big_integer const& b);
+
+    // q = a / b and r = a % b rounding toward zero, q and r distinct
+    void divmod(big_integer& q, big_integer& r, big_integer const& a, big_integer const& b);
+    void div(big_integer& q, big_integer const& a, big_integer const& b);
+    void mod(big_integer& r, big_integer const& a, big_integer const& b);
+
+    void divmod(big_integer& q, big_integer& r, big_integer const& a, big_divisor const& d);
+    void div(big_integer& q, big_integer const& a, big_divisor const& d);
+    void mod(big_integer& r, big_integer const& a, big_divisor const& d);
+
+    // s = to_string(a) in the characters s already has. Numbers above about 600 digits go through
+    // the divide and conquer to_string, which allocates
+    void to_string(std::string& s, big_integer const& a);
+
+private:
+    big_integer::limb_vector operands;
+    big_integer::limb_vector product;
+    big_integer::limb_vector buffer;
+};
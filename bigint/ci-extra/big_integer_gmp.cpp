@@ -29,6 +29,17 @@ big_integer_gmp::big_integer_gmp(std::string const& str)
     }
 }
 
+big_integer_gmp big_integer_gmp::from_limbs(uint32_t const* magnitude, size_t n, bool negative)
+{
+    big_integer_gmp result;
+    mpz_import(result.mpz, n, -1, sizeof(uint32_t), 0, 0, magnitude);
+    if (negative)
+    {
+        mpz_neg(result.mpz, result.mpz);
+    }
+    return result;
+}
+
 big_integer_gmp::~big_integer_gmp()
 {
     mpz_clear(mpz);
@@ -225,6 +236,25 @@ bool operator>=(big_integer_gmp const& a, big_integer_gmp const& b)
     return mpz_cmp(a.mpz, b.mpz) >= 0;
 }
 
+big_integer_gmp pow_mod(big_integer_gmp const& base, big_integer_gmp const& exponent, big_integer_gmp const& modulus)
+{
+    big_integer_gmp result;
+    mpz_powm(result.mpz, base.mpz, exponent.mpz, modulus.mpz);
+    return result;
+}
+
+bool is_probable_prime(big_integer_gmp const& a)
+{
+    return mpz_probab_prime_p(a.mpz, 25) != 0;
+}
+
+big_integer_gmp next_prime(big_integer_gmp const& a)
+{
+    big_integer_gmp result;
+    mpz_nextprime(result.mpz, a.mpz);
+    return result;
+}
+
 std::string to_string(big_integer_gmp const& a)
 {
     char* tmp = mpz_get_str(nullptr, 10, a.mpz);
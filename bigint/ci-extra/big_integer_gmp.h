@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 #include <gmp.h>
 #include <iosfwd>
 
@@ -10,6 +11,7 @@ struct big_integer_gmp
     big_integer_gmp(big_integer_gmp const& other);
     big_integer_gmp(int a);
     explicit big_integer_gmp(std::string const& str);
+    static big_integer_gmp from_limbs(uint32_t const* magnitude, size_t n, bool negative);
 
     template <typename RNG>
     big_integer_gmp& random(size_t sz, RNG&& rng)
@@ -61,6 +63,11 @@ struct big_integer_gmp
 
     friend std::string to_string(big_integer_gmp const& a);
 
+    friend big_integer_gmp pow_mod(big_integer_gmp const& base, big_integer_gmp const& exponent,
+                                   big_integer_gmp const& modulus);
+    friend bool is_probable_prime(big_integer_gmp const& a);
+    friend big_integer_gmp next_prime(big_integer_gmp const& a);
+
 private:
     mpz_t mpz;
 };
@@ -85,5 +92,9 @@ bool operator>(big_integer_gmp const& a, big_integer_gmp const& b);
 bool operator<=(big_integer_gmp const& a, big_integer_gmp const& b);
 bool operator>=(big_integer_gmp const& a, big_integer_gmp const& b);
 
+big_integer_gmp pow_mod(big_integer_gmp const& base, big_integer_gmp const& exponent, big_integer_gmp const& modulus);
+bool is_probable_prime(big_integer_gmp const& a);
+big_integer_gmp next_prime(big_integer_gmp const& a);
+
 std::string to_string(big_integer_gmp const& a);
 std::ostream& operator<<(std::ostream& s, big_integer_gmp const& a);
@@ -7,6 +7,7 @@
 #include <gtest/gtest.h>
 
 #include "../big_integer.h"
+#include "../big_divisor.h"
 #include "big_integer_gmp.h"
 
 namespace
@@ -279,3 +280,143 @@ TEST(correctness_random, bit_shifts)
         EXPECT_EQ(to_string(a >> shift), to_string(R >> shift));
     }
 }
+
+TEST(correctness_random, batch)
+{
+    std::default_random_engine rng(42);
+    std::vector<big_integer_gmp> a(NUMBER_OF_ITERATIONS), b(NUMBER_OF_ITERATIONS);
+    std::vector<big_integer> A, B;
+    for (size_t i = 0; i != NUMBER_OF_ITERATIONS; ++i)
+    {
+        a[i].random(MAX_SIZE, rng);
+        b[i].random(MAX_SIZE, rng);
+        A.emplace_back(to_string(a[i]));
+        B.emplace_back(to_string(b[i]));
+    }
+
+    std::vector<big_integer> R(NUMBER_OF_ITERATIONS);
+    add_n(R.data(), A.data(), B.data(), R.size());
+    for (size_t i = 0; i != NUMBER_OF_ITERATIONS; ++i)
+        EXPECT_EQ(to_string(a[i] + b[i]), to_string(R[i]));
+
+    sub_n(R.data(), A.data(), B.data(), R.size());
+    for (size_t i = 0; i != NUMBER_OF_ITERATIONS; ++i)
+        EXPECT_EQ(to_string(a[i] - b[i]), to_string(R[i]));
+
+    mul_n(R.data(), A.data(), B.data(), R.size());
+    for (size_t i = 0; i != NUMBER_OF_ITERATIONS; ++i)
+        EXPECT_EQ(to_string(a[i] * b[i]), to_string(R[i]));
+}
+
+TEST(correctness_random, mul_large)
+{
+    std::default_random_engine rng(42);
+    for (size_t itn = 0; itn != NUMBER_OF_ITERATIONS; ++itn)
+    {
+        big_integer_gmp a, b;
+        a.random(MAX_SIZE * 16, rng);
+        b.random(MAX_SIZE * (itn + 1), rng);
+        big_integer_gmp c = a * b;
+        big_integer R = big_integer(to_string(a)) * big_integer(to_string(b));
+        EXPECT_EQ(to_string(c), to_string(R));
+    }
+}
+
+TEST(correctness_random, divexact)
+{
+    std::default_random_engine rng(322);
+    for (size_t itn = 0; itn != NUMBER_OF_ITERATIONS; ++itn)
+    {
+        big_integer_gmp a, b;
+        a.random(MAX_SIZE, rng);
+        b.random(MAX_SIZE / 2, rng);
+        if (b == 0)
+            continue;
+        big_integer_gmp c = a * b;
+        big_integer A = big_integer(to_string(a));
+        big_integer B = big_integer(to_string(b));
+        big_integer C = big_integer(to_string(c));
+        EXPECT_EQ(to_string(a), to_string(divexact(C, B)));
+        EXPECT_EQ(to_string(b), to_string(divexact(C, A)));
+
+        EXPECT_TRUE(divisible_by(C, A));
+        EXPECT_TRUE(divisible_by(C, B));
+        EXPECT_EQ(to_string((c + 1) % b) == "0", divisible_by(C + 1, B));
+        EXPECT_EQ(to_string(a % b) == "0", divisible_by(A, B));
+    }
+}
+
+TEST(correctness_random, divmod)
+{
+    std::default_random_engine rng(322);
+    for (size_t itn = 0; itn != NUMBER_OF_ITERATIONS; ++itn)
+    {
+        big_integer_gmp a, b;
+        a.random(MAX_SIZE, rng);
+        b.random(MAX_SIZE / 2, rng);
+        std::pair<big_integer, big_integer> R = divmod(big_integer(to_string(a)), big_integer(to_string(b)));
+        EXPECT_EQ(to_string(a / b), to_string(R.first));
+        EXPECT_EQ(to_string(a % b), to_string(R.second));
+    }
+}
+
+TEST(correctness_random, big_divisor)
+{
+    std::default_random_engine rng(322);
+    for (size_t itn = 0; itn != NUMBER_OF_ITERATIONS; ++itn)
+    {
+        big_integer_gmp b;
+        b.random(MAX_SIZE * (itn + 1), rng);
+        if (b == 0)
+            continue;
+        big_divisor d(big_integer(to_string(b)));
+        for (size_t i = 0; i != 4; ++i)
+        {
+            big_integer_gmp a;
+            a.random(MAX_SIZE * (itn + 1) * (i + 1), rng);
+            big_integer A(to_string(a));
+            EXPECT_EQ(to_string(a / b), to_string(A / d));
+            EXPECT_EQ(to_string(a % b), to_string(A % d));
+        }
+    }
+}
+
+TEST(correctness_random, pow_mod)
+{
+    std::default_random_engine rng(322);
+    for (size_t itn = 0; itn != NUMBER_OF_ITERATIONS; ++itn)
+    {
+        big_integer_gmp a, e, m;
+        a.random(MAX_SIZE, rng);
+        e.random(MAX_SIZE / 4, rng);
+        m.random(MAX_SIZE / 2, rng);
+        if (e < 0)
+            e = -e;
+        if (m < 0)
+            m = -m;
+        if (m == 0)
+            continue;
+        big_integer_gmp r = pow_mod(a, e, m);
+        if (r < 0)
+            r += m;
+        EXPECT_EQ(to_string(r), to_string(pow_mod(big_integer(to_string(a)), big_integer(to_string(e)),
+                                                  big_integer(to_string(m)))));
+    }
+}
+
+TEST(correctness_random, primes)
+{
+    std::default_random_engine rng(322);
+    for (size_t itn = 0; itn != NUMBER_OF_ITERATIONS; ++itn)
+    {
+        big_integer_gmp a;
+        a.random(MAX_SIZE / 4, rng);
+        big_integer_gmp p = next_prime(a < 0 ? -a : a);
+        big_integer A(to_string(a < 0 ? -a : a));
+        big_integer P = next_prime(A);
+        EXPECT_EQ(to_string(p), to_string(P));
+        EXPECT_TRUE(is_probable_prime(P));
+        EXPECT_EQ(is_probable_prime(a), is_probable_prime(big_integer(to_string(a))));
+        EXPECT_FALSE(is_probable_prime(P * next_prime(P)));
+    }
+}
@@ -0,0 +1,243 @@
+#pragma once
+
+#include "big_integer.h"
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+// sign and magnitude in N 32-bit limbs; parsing and arithmetic are constexpr,
+// so constants built from it are computed by the compiler and stored as plain data
+template <size_t N>
+struct constant_integer
+{
+    constexpr constant_integer() : negative(false), limbs{} {}
+
+    constexpr constant_integer(unsigned long long a) : negative(false), limbs{} {
+        for (size_t i = 0; i < N && a != 0; i++) {
+            limbs[i] = static_cast<uint32_t>(a);
+            a >>= 32;
+        }
+        if (a != 0) {
+            throw std::overflow_error("constant_integer");
+        }
+    }
+
+    constexpr explicit constant_integer(char const* str) : negative(false), limbs{} {
+        if (*str == '-' || *str == '+') {
+            negative = *str == '-';
+            str++;
+        }
+        if (*str == 0) {
+            throw std::invalid_argument(str);
+        }
+        for (; *str != 0; str++) {
+            if (*str < '0' || *str > '9') {
+                throw std::invalid_argument(str);
+            }
+            mul_add(10, static_cast<uint32_t>(*str - '0'));
+        }
+        negative = negative && !is_zero();
+    }
+
+    template <size_t M>
+    constexpr constant_integer(constant_integer<M> const& other) : negative(other.negative), limbs{} {
+        for (size_t i = 0; i < M; i++) {
+            if (i < N) {
+                limbs[i] = other.limbs[i];
+            } else if (other.limbs[i] != 0) {
+                throw std::overflow_error("constant_integer");
+            }
+        }
+    }
+
+    operator big_integer() const {
+        return big_integer::from_limbs(limbs, N, negative);
+    }
+
+    constexpr bool is_zero() const {
+        for (size_t i = 0; i < N; i++) {
+            if (limbs[i] != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    constexpr void mul_add(uint32_t m, uint32_t add) {
+        uint64_t carry = add;
+        for (size_t i = 0; i < N; i++) {
+            carry += static_cast<uint64_t>(limbs[i]) * m;
+            limbs[i] = static_cast<uint32_t>(carry);
+            carry >>= 32;
+        }
+        if (carry != 0) {
+            throw std::overflow_error("constant_integer");
+        }
+    }
+
+    constexpr constant_integer operator+() const {
+        return *this;
+    }
+
+    constexpr constant_integer operator-() const {
+        constant_integer result = *this;
+        result.negative = !negative && !is_zero();
+        return result;
+    }
+
+    bool negative;
+    uint32_t limbs[N];
+};
+
+namespace constant_integer_detail
+{
+    constexpr uint32_t limb(uint32_t const* a, size_t n, size_t i) {
+        return i < n ? a[i] : 0;
+    }
+
+    constexpr int compare(uint32_t const* a, size_t na, uint32_t const* b, size_t nb) {
+        for (size_t i = na > nb ? na : nb; i > 0; i--) {
+            uint32_t x = limb(a, na, i - 1);
+            uint32_t y = limb(b, nb, i - 1);
+            if (x != y) {
+                return x < y ? -1 : 1;
+            }
+        }
+        return 0;
+    }
+
+    constexpr void add(uint32_t* r, size_t nr, uint32_t const* a, size_t na, uint32_t const* b, size_t nb) {
+        uint64_t carry = 0;
+        for (size_t i = 0; i < nr; i++) {
+            carry += static_cast<uint64_t>(limb(a, na, i)) + limb(b, nb, i);
+            r[i] = static_cast<uint32_t>(carry);
+            carry >>= 32;
+        }
+    }
+
+    // r = a - b for a >= b
+    constexpr void sub(uint32_t* r, size_t nr, uint32_t const* a, size_t na, uint32_t const* b, size_t nb) {
+        uint64_t borrow = 0;
+        for (size_t i = 0; i < nr; i++) {
+            uint64_t res = static_cast<uint64_t>(limb(a, na, i)) - limb(b, nb, i) - borrow;
+            r[i] = static_cast<uint32_t>(res);
+            borrow = res >> 63;
+        }
+    }
+
+    template <size_t R, size_t N, size_t M>
+    constexpr constant_integer<R> add_signed(constant_integer<N> const& a, constant_integer<M> const& b,
+                                             bool negate_b) {
+        constant_integer<R> result;
+        bool negative_b = b.negative != negate_b;
+        if (a.negative == negative_b) {
+            add(result.limbs, R, a.limbs, N, b.limbs, M);
+            result.negative = a.negative;
+        } else if (compare(a.limbs, N, b.limbs, M) >= 0) {
+            sub(result.limbs, R, a.limbs, N, b.limbs, M);
+            result.negative = a.negative;
+        } else {
+            sub(result.limbs, R, b.limbs, M, a.limbs, N);
+            result.negative = negative_b;
+        }
+        result.negative = result.negative && !result.is_zero();
+        return result;
+    }
+}
+
+template <size_t N, size_t M>
+constexpr constant_integer<(N > M ? N : M) + 1> operator+(constant_integer<N> const& a, constant_integer<M> const& b) {
+    return constant_integer_detail::add_signed<(N > M ? N : M) + 1>(a, b, false);
+}
+
+template <size_t N, size_t M>
+constexpr constant_integer<(N > M ? N : M) + 1> operator-(constant_integer<N> const& a, constant_integer<M> const& b) {
+    return constant_integer_detail::add_signed<(N > M ? N : M) + 1>(a, b, true);
+}
+
+template <size_t N, size_t M>
+constexpr constant_integer<N + M> operator*(constant_integer<N> const& a, constant_integer<M> const& b) {
+    constant_integer<N + M> result;
+    for (size_t i = 0; i < M; i++) {
+        uint64_t carry = 0;
+        for (size_t j = 0; j < N; j++) {
+            carry += static_cast<uint64_t>(a.limbs[j]) * b.limbs[i] + result.limbs[i + j];
+            result.limbs[i + j] = static_cast<uint32_t>(carry);
+            carry >>= 32;
+        }
+        result.limbs[i + N] = static_cast<uint32_t>(carry);
+    }
+    result.negative = (a.negative != b.negative) && !result.is_zero();
+    return result;
+}
+
+template <size_t N, size_t M>
+constexpr bool operator==(constant_integer<N> const& a, constant_integer<M> const& b) {
+    return a.negative == b.negative && constant_integer_detail::compare(a.limbs, N, b.limbs, M) == 0;
+}
+
+template <size_t N, size_t M>
+constexpr bool operator!=(constant_integer<N> const& a, constant_integer<M> const& b) {
+    return !(a == b);
+}
+
+template <size_t N, size_t M>
+constexpr bool operator<(constant_integer<N> const& a, constant_integer<M> const& b) {
+    if (a.negative != b.negative) {
+        return a.negative;
+    }
+    int cmp = constant_integer_detail::compare(a.limbs, N, b.limbs, M);
+    return a.negative ? cmp > 0 : cmp < 0;
+}
+
+template <size_t N, size_t M>
+constexpr bool operator>(constant_integer<N> const& a, constant_integer<M> const& b) {
+    return b < a;
+}
+
+template <size_t N, size_t M>
+constexpr bool operator<=(constant_integer<N> const& a, constant_integer<M> const& b) {
+    return !(b < a);
+}
+
+template <size_t N, size_t M>
+constexpr bool operator>=(constant_integer<N> const& a, constant_integer<M> const& b) {
+    return !(a < b);
+}
+
+namespace big_integer_literals
+{
+    // decimal, 0x hexadecimal, 0b binary or 0-prefixed octal literal read as the language reads
+    // integer literals, digit separators allowed: 1'000'000_bi
+    template <char... Digits>
+    constexpr constant_integer<(sizeof...(Digits) * 4 + 31) / 32> operator"" _bi() {
+        constexpr char digits[] = {Digits..., 0};
+        constant_integer<(sizeof...(Digits) * 4 + 31) / 32> result;
+        uint32_t base = 10;
+        size_t i = 0;
+        if (digits[0] == '0' && (digits[1] == 'x' || digits[1] == 'X')) {
+            base = 16;
+            i = 2;
+        } else if (digits[0] == '0' && (digits[1] == 'b' || digits[1] == 'B')) {
+            base = 2;
+            i = 2;
+        } else if (digits[0] == '0') {
+            base = 8;
+        }
+        for (; digits[i] != 0; i++) {
+            char c = digits[i];
+            if (c == '\'') {
+                continue;
+            }
+            uint32_t digit = c >= 'a' && c <= 'f' ? c - 'a' + 10
+                           : c >= 'A' && c <= 'F' ? c - 'A' + 10
+                           : c >= '0' && c <= '9' ? c - '0'
+                           : base;
+            if (digit >= base) {
+                throw std::invalid_argument(digits);
+            }
+            result.mul_add(base, digit);
+        }
+        return result;
+    }
+}
@@ -0,0 +1,440 @@
+#pragma once
+
+#include "big_integer.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+// Bits-wide two's complement integer kept in place, with the same operators as big_integer;
+// arithmetic wraps modulo 2^Bits like built-in integers and never allocates
+template <size_t Bits, bool Signed = true>
+struct fixed_integer
+{
+    static_assert(Bits > 0 && Bits % 32 == 0, "fixed_integer width must be a multiple of 32 bits");
+
+    static constexpr size_t size = Bits / 32;
+    using limbs = std::array<uint32_t, size>;
+
+    fixed_integer() : number{} {}
+
+    template <typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+    fixed_integer(T a) {
+        auto value = static_cast<uint64_t>(a);
+        uint32_t fill = std::is_signed<T>::value && a < 0 ? UINT32_MAX : 0;
+        number.fill(fill);
+        number[0] = static_cast<uint32_t>(value);
+        if (size > 1) {
+            // limb 1; the index stays in bounds for size == 1, where this branch is compiled but dead
+            number[std::min<size_t>(1, size - 1)] = static_cast<uint32_t>(value >> 32);
+        }
+    }
+
+    explicit fixed_integer(big_integer const& a) {
+        for (size_t i = 0; i < size; i++) {
+            number[i] = a[i];
+        }
+    }
+
+    explicit fixed_integer(std::string const& str) : number{} {
+        size_t i = str.size() > 1 && (str[0] == '-' || str[0] == '+') ? 1 : 0;
+        if (i == str.size()) {
+            throw std::invalid_argument(str);
+        }
+        for (; i < str.size(); i++) {
+            if (str[i] < '0' || str[i] > '9') {
+                throw std::invalid_argument(str);
+            }
+            mul_add(number, 10, static_cast<uint32_t>(str[i] - '0'));
+        }
+        if (str[0] == '-') {
+            negate(number);
+        }
+    }
+
+    template <size_t OtherBits, bool OtherSigned>
+    explicit fixed_integer(fixed_integer<OtherBits, OtherSigned> const& other) {
+        uint32_t fill = other.is_negative() ? UINT32_MAX : 0;
+        for (size_t i = 0; i < size; i++) {
+            number[i] = i < other.size ? other.number[i] : fill;
+        }
+    }
+
+    explicit operator big_integer() const {
+        if (!is_negative()) {
+            return big_integer::from_limbs(number.data(), size, false);
+        }
+        limbs magnitude = number;
+        negate(magnitude);
+        return big_integer::from_limbs(magnitude.data(), size, true);
+    }
+
+    fixed_integer& operator+=(fixed_integer const& rhs) {
+        uint64_t carry = 0;
+        for (size_t i = 0; i < size; i++) {
+            carry += static_cast<uint64_t>(number[i]) + rhs.number[i];
+            number[i] = static_cast<uint32_t>(carry);
+            carry >>= 32;
+        }
+        return *this;
+    }
+
+    fixed_integer& operator-=(fixed_integer const& rhs) {
+        uint64_t borrow = 0;
+        for (size_t i = 0; i < size; i++) {
+            uint64_t res = static_cast<uint64_t>(number[i]) - rhs.number[i] - borrow;
+            number[i] = static_cast<uint32_t>(res);
+            borrow = res >> 63;
+        }
+        return *this;
+    }
+
+    fixed_integer& operator*=(fixed_integer const& rhs) {
+        limbs result{};
+        for (size_t i = 0; i < size; i++) {
+            uint64_t carry = 0;
+            for (size_t j = 0; i + j < size; j++) {
+                carry += static_cast<uint64_t>(number[j]) * rhs.number[i] + result[i + j];
+                result[i + j] = static_cast<uint32_t>(carry);
+                carry >>= 32;
+            }
+        }
+        number = result;
+        return *this;
+    }
+
+    fixed_integer& operator/=(fixed_integer const& rhs) {
+        limbs remainder;
+        divide(*this, rhs, number, remainder);
+        return *this;
+    }
+
+    fixed_integer& operator%=(fixed_integer const& rhs) {
+        limbs quotient;
+        divide(*this, rhs, quotient, number);
+        return *this;
+    }
+
+    fixed_integer& operator&=(fixed_integer const& rhs) {
+        for (size_t i = 0; i < size; i++) {
+            number[i] &= rhs.number[i];
+        }
+        return *this;
+    }
+
+    fixed_integer& operator|=(fixed_integer const& rhs) {
+        for (size_t i = 0; i < size; i++) {
+            number[i] |= rhs.number[i];
+        }
+        return *this;
+    }
+
+    fixed_integer& operator^=(fixed_integer const& rhs) {
+        for (size_t i = 0; i < size; i++) {
+            number[i] ^= rhs.number[i];
+        }
+        return *this;
+    }
+
+    fixed_integer& operator<<=(int rhs) {
+        auto shift = static_cast<size_t>(rhs) / 32;
+        auto bits = static_cast<unsigned>(rhs) % 32;
+        for (size_t i = size; i > 0; i--) {
+            uint32_t high = i - 1 >= shift ? number[i - 1 - shift] : 0;
+            uint32_t low = i - 1 >= shift + 1 ? number[i - 2 - shift] : 0;
+            number[i - 1] = bits == 0 ? high : (high << bits) | (low >> (32 - bits));
+        }
+        return *this;
+    }
+
+    fixed_integer& operator>>=(int rhs) {
+        auto shift = static_cast<size_t>(rhs) / 32;
+        auto bits = static_cast<unsigned>(rhs) % 32;
+        uint32_t fill = is_negative() ? UINT32_MAX : 0;
+        for (size_t i = 0; i < size; i++) {
+            uint32_t low = i + shift < size ? number[i + shift] : fill;
+            uint32_t high = i + shift + 1 < size ? number[i + shift + 1] : fill;
+            number[i] = bits == 0 ? low : (low >> bits) | (high << (32 - bits));
+        }
+        return *this;
+    }
+
+    fixed_integer operator+() const {
+        return *this;
+    }
+
+    fixed_integer operator-() const {
+        fixed_integer result = *this;
+        negate(result.number);
+        return result;
+    }
+
+    fixed_integer operator~() const {
+        fixed_integer result;
+        for (size_t i = 0; i < size; i++) {
+            result.number[i] = ~number[i];
+        }
+        return result;
+    }
+
+    fixed_integer& operator++() {
+        return *this += 1;
+    }
+
+    fixed_integer operator++(int) {
+        fixed_integer tmp(*this);
+        *this += 1;
+        return tmp;
+    }
+
+    fixed_integer& operator--() {
+        return *this -= 1;
+    }
+
+    fixed_integer operator--(int) {
+        fixed_integer tmp(*this);
+        *this -= 1;
+        return tmp;
+    }
+
+    uint32_t operator[](size_t i) const {
+        return number[i];
+    }
+
+    bool is_negative() const {
+        return Signed && (number[size - 1] >> 31) != 0;
+    }
+
+    friend fixed_integer operator+(fixed_integer a, fixed_integer const& b) {
+        return a += b;
+    }
+
+    friend fixed_integer operator-(fixed_integer a, fixed_integer const& b) {
+        return a -= b;
+    }
+
+    friend fixed_integer operator*(fixed_integer a, fixed_integer const& b) {
+        return a *= b;
+    }
+
+    friend fixed_integer operator/(fixed_integer a, fixed_integer const& b) {
+        return a /= b;
+    }
+
+    friend fixed_integer operator%(fixed_integer a, fixed_integer const& b) {
+        return a %= b;
+    }
+
+    friend fixed_integer operator&(fixed_integer a, fixed_integer const& b) {
+        return a &= b;
+    }
+
+    friend fixed_integer operator|(fixed_integer a, fixed_integer const& b) {
+        return a |= b;
+    }
+
+    friend fixed_integer operator^(fixed_integer a, fixed_integer const& b) {
+        return a ^= b;
+    }
+
+    friend fixed_integer operator<<(fixed_integer a, int b) {
+        return a <<= b;
+    }
+
+    friend fixed_integer operator>>(fixed_integer a, int b) {
+        return a >>= b;
+    }
+
+    friend bool operator==(fixed_integer const& a, fixed_integer const& b) {
+        return a.number == b.number;
+    }
+
+    friend bool operator!=(fixed_integer const& a, fixed_integer const& b) {
+        return !(a == b);
+    }
+
+    friend bool operator<(fixed_integer const& a, fixed_integer const& b) {
+        if (a.is_negative() != b.is_negative()) {
+            return a.is_negative();
+        }
+        return compare(a.number, b.number) < 0;
+    }
+
+    friend bool operator>(fixed_integer const& a, fixed_integer const& b) {
+        return b < a;
+    }
+
+    friend bool operator<=(fixed_integer const& a, fixed_integer const& b) {
+        return !(b < a);
+    }
+
+    friend bool operator>=(fixed_integer const& a, fixed_integer const& b) {
+        return !(a < b);
+    }
+
+    friend std::string to_string(fixed_integer const& a) {
+        limbs magnitude = a.number;
+        if (a.is_negative()) {
+            negate(magnitude);
+        }
+        std::string digits;
+        do {
+            uint32_t block = divide_short(magnitude, magnitude, 1'000'000'000);
+            for (int i = 0; i < 9; i++) {
+                digits += static_cast<char>('0' + block % 10);
+                block /= 10;
+            }
+        } while (compare(magnitude, limbs{}) != 0);
+        while (digits.size() > 1 && digits.back() == '0') {
+            digits.pop_back();
+        }
+        if (a.is_negative()) {
+            digits += '-';
+        }
+        return std::string(digits.rbegin(), digits.rend());
+    }
+
+    friend std::ostream& operator<<(std::ostream& s, fixed_integer const& a) {
+        return s << to_string(a);
+    }
+
+private:
+    template <size_t, bool>
+    friend struct fixed_integer;
+
+    static void negate(limbs& a) {
+        uint64_t carry = 1;
+        for (size_t i = 0; i < size; i++) {
+            carry += static_cast<uint32_t>(~a[i]);
+            a[i] = static_cast<uint32_t>(carry);
+            carry >>= 32;
+        }
+    }
+
+    static void mul_add(limbs& a, uint32_t m, uint32_t add) {
+        uint64_t carry = add;
+        for (size_t i = 0; i < size; i++) {
+            carry += static_cast<uint64_t>(a[i]) * m;
+            a[i] = static_cast<uint32_t>(carry);
+            carry >>= 32;
+        }
+    }
+
+    static int compare(limbs const& a, limbs const& b) {
+        for (size_t i = size; i > 0; i--) {
+            if (a[i - 1] != b[i - 1]) {
+                return a[i - 1] < b[i - 1] ? -1 : 1;
+            }
+        }
+        return 0;
+    }
+
+    static uint32_t divide_short(limbs& q, limbs const& a, uint32_t b) {
+        uint64_t rest = 0;
+        for (size_t i = size; i > 0; i--) {
+            rest = (rest << 32) | a[i - 1];
+            q[i - 1] = static_cast<uint32_t>(rest / b);
+            rest %= b;
+        }
+        return static_cast<uint32_t>(rest);
+    }
+
+    // truncating division of the magnitudes (Knuth's algorithm D), the signs are applied afterwards
+    static void divide(fixed_integer const& a, fixed_integer const& b, limbs& q, limbs& r) {
+        bool negative_a = a.is_negative();
+        bool negative_b = b.is_negative();
+        limbs x = a.number;
+        limbs y = b.number;
+        if (negative_a) {
+            negate(x);
+        }
+        if (negative_b) {
+            negate(y);
+        }
+        size_t n = size;
+        size_t m = size;
+        while (n > 1 && x[n - 1] == 0) {
+            n--;
+        }
+        while (m > 1 && y[m - 1] == 0) {
+            m--;
+        }
+        q.fill(0);
+        r.fill(0);
+        if (compare(x, y) < 0) {
+            r = x;
+        } else if (m == 1) {
+            r[0] = divide_short(q, x, y[0]);
+        } else {
+            unsigned s = 0;
+            while ((y[m - 1] << s >> 31) == 0) {
+                s++;
+            }
+            std::array<uint32_t, size + 1> u{};
+            limbs v{};
+            for (size_t i = m; i > 0; i--) {
+                v[i - 1] = s == 0 ? y[i - 1] : (y[i - 1] << s) | (i > 1 ? y[i - 2] >> (32 - s) : 0);
+            }
+            for (size_t i = n + 1; i > 0; i--) {
+                uint32_t high = i - 1 < n ? x[i - 1] : 0;
+                uint32_t low = i > 1 ? x[i - 2] : 0;
+                u[i - 1] = s == 0 ? high : (high << s) | (low >> (32 - s));
+            }
+            for (size_t j = n - m + 1; j > 0;) {
+                j--;
+                uint64_t current = (static_cast<uint64_t>(u[j + m]) << 32) | u[j + m - 1];
+                uint64_t qt = current / v[m - 1];
+                uint64_t rt = current % v[m - 1];
+                while (qt > UINT32_MAX || qt * v[m - 2] > ((rt << 32) | u[j + m - 2])) {
+                    qt--;
+                    rt += v[m - 1];
+                    if (rt > UINT32_MAX) {
+                        break;
+                    }
+                }
+                int64_t borrow = 0;
+                uint64_t carry = 0;
+                for (size_t i = 0; i <= m; i++) {
+                    carry += i < m ? qt * v[i] : 0;
+                    int64_t res = static_cast<int64_t>(u[i + j]) - static_cast<uint32_t>(carry) + borrow;
+                    u[i + j] = static_cast<uint32_t>(res);
+                    borrow = res >> 32;
+                    carry >>= 32;
+                }
+                if (borrow != 0) {
+                    qt--;
+                    carry = 0;
+                    for (size_t i = 0; i <= m; i++) {
+                        carry += static_cast<uint64_t>(u[i + j]) + (i < m ? v[i] : 0);
+                        u[i + j] = static_cast<uint32_t>(carry);
+                        carry >>= 32;
+                    }
+                }
+                q[j] = static_cast<uint32_t>(qt);
+            }
+            for (size_t i = 0; i < m; i++) {
+                r[i] = s == 0 ? u[i] : (u[i] >> s) | (u[i + 1] << (32 - s));
+            }
+        }
+        if (negative_a != negative_b) {
+            negate(q);
+        }
+        if (negative_a) {
+            negate(r);
+        }
+    }
+
+    limbs number;
+};
+
+template <size_t Bits, bool Signed>
+constexpr size_t fixed_integer<Bits, Signed>::size;
+
+using uint256 = fixed_integer<256, false>;
+using int256 = fixed_integer<256, true>;
+using uint512 = fixed_integer<512, false>;
+using int512 = fixed_integer<512, true>;
@@ -0,0 +1,110 @@
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <string>
+#include <gtest/gtest.h>
+
+#include "big_integer.h"
+#include "fixed_integer.h"
+
+TEST(fixed_integer, basic)
+{
+    int256 a = 2;
+    int256 b = -3;
+
+    EXPECT_EQ(-1, a + b);
+    EXPECT_EQ(5, a - b);
+    EXPECT_EQ(-6, a * b);
+    EXPECT_EQ(0, a / b);
+    EXPECT_EQ(-1, b / a);
+    EXPECT_EQ(-1, b % a);
+    EXPECT_EQ(b, ~a);
+    EXPECT_EQ(-12, b << 2);
+    EXPECT_EQ(-2, b >> 1);
+    EXPECT_TRUE(b < a);
+    EXPECT_EQ("-3", to_string(b));
+    EXPECT_EQ("0", to_string(int256()));
+}
+
+TEST(fixed_integer, wraps)
+{
+    uint256 max = ~uint256();
+    EXPECT_EQ(0, max + 1);
+    EXPECT_EQ(max, uint256() - 1);
+    EXPECT_TRUE(uint256(1) < max);
+    EXPECT_EQ("115792089237316195423570985008687907853269984665640564039457584007913129639935", to_string(max));
+
+    int256 min = int256(1) << 255;
+    EXPECT_TRUE(min < 0);
+    EXPECT_EQ(min, -min);
+    EXPECT_EQ(min, min / -1);
+    EXPECT_EQ(int256(-1), int256(max));
+}
+
+TEST(fixed_integer, conversions)
+{
+    big_integer a("-123456789012345678901234567890123456789");
+    EXPECT_EQ(a, big_integer(int256(a)));
+    EXPECT_EQ(a, big_integer(int512(a)));
+    EXPECT_EQ(a, big_integer(int512(int256(a))));
+    EXPECT_EQ(int256("-123456789012345678901234567890123456789"), int256(a));
+    EXPECT_EQ((big_integer(1) << 256) + a, big_integer(uint256(a)));
+    EXPECT_EQ(std::numeric_limits<int64_t>::min(), big_integer(int256(std::numeric_limits<int64_t>::min())));
+    EXPECT_EQ(std::numeric_limits<uint64_t>::max(), big_integer(uint512(std::numeric_limits<uint64_t>::max())));
+    EXPECT_THROW(int256("12-3"), std::invalid_argument);
+}
+
+namespace
+{
+    template <typename F>
+    big_integer wrap(big_integer const& x)
+    {
+        return big_integer(F(x));
+    }
+
+    template <typename F>
+    void check_against_big_integer(std::mt19937& rng)
+    {
+        for (int itn = 0; itn < 200; ++itn)
+        {
+            big_integer x;
+            big_integer y;
+            for (size_t i = 0; i < F::size; ++i)
+            {
+                x = (x << 32) + rng();
+                y = (y << 32) + (i < (itn % F::size) + 1 ? rng() : 0);
+            }
+            F a(x);
+            F b(y);
+            x = wrap<F>(x);
+            y = wrap<F>(y);
+            int shift = static_cast<int>(rng() % (32 * F::size));
+
+            EXPECT_EQ(wrap<F>(x + y), big_integer(a + b));
+            EXPECT_EQ(wrap<F>(x - y), big_integer(a - b));
+            EXPECT_EQ(wrap<F>(x * y), big_integer(a * b));
+            EXPECT_EQ(wrap<F>(x & y), big_integer(a & b));
+            EXPECT_EQ(wrap<F>(x | y), big_integer(a | b));
+            EXPECT_EQ(wrap<F>(x ^ y), big_integer(a ^ b));
+            EXPECT_EQ(wrap<F>(x << shift), big_integer(a << shift));
+            EXPECT_EQ(wrap<F>(x >> shift), big_integer(a >> shift));
+            EXPECT_EQ(x < y, a < b);
+            EXPECT_EQ(to_string(x), to_string(a));
+            if (y != 0)
+            {
+                EXPECT_EQ(wrap<F>(x / y), big_integer(a / b));
+                EXPECT_EQ(wrap<F>(x % y), big_integer(a % b));
+            }
+        }
+    }
+} // namespace
+
+TEST(fixed_integer, randomized)
+{
+    std::mt19937 rng(42);
+    check_against_big_integer<int256>(rng);
+    check_against_big_integer<uint256>(rng);
+    check_against_big_integer<int512>(rng);
+    check_against_big_integer<fixed_integer<64, true>>(rng);
+    check_against_big_integer<fixed_integer<32, false>>(rng);
+}
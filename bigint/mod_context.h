@@ -0,0 +1,69 @@
+#pragma once
+
+#include "big_integer.h"
+#include <memory>
+#include <vector>
+
+struct residue;
+
+// Arithmetic modulo a fixed odd modulus in Montgomery form. The constructor computes the constants
+// and allocates the scratch space, so add, sub, mul, pow and inverse on residues of one context
+// write into the limbs the residues already have and do not allocate once pow has seen its
+// largest window. A context is used by one thread at a time and must outlive its residues.
+struct mod_context
+{
+    // throws std::invalid_argument unless the modulus is odd and greater than 1
+    explicit mod_context(big_integer const& modulus);
+    ~mod_context();
+
+    mod_context(mod_context const&) = delete;
+    mod_context& operator=(mod_context const&) = delete;
+
+    big_integer const& modulus() const;
+
+    // r = a op b, r may alias the operands
+    void add(residue& r, residue const& a, residue const& b);
+    void sub(residue& r, residue const& a, residue const& b);
+    void mul(residue& r, residue const& a, residue const& b);
+    // exponent >= 0
+    void pow(residue& r, residue const& a, big_integer const& exponent);
+    // throws std::invalid_argument when a is not coprime to the modulus
+    void inverse(residue& r, residue const& a);
+
+private:
+    friend struct residue;
+    struct state;
+
+    big_integer modulus_;
+    std::unique_ptr<state> data;
+};
+
+// a value modulo the modulus of its context, stored as a * beta^n mod modulus in n limbs
+struct residue
+{
+    explicit residue(mod_context& context);
+    residue(mod_context& context, big_integer const& a);
+
+    // in [0, modulus)
+    big_integer value() const;
+
+    residue& operator+=(residue const& rhs);
+    residue& operator-=(residue const& rhs);
+    residue& operator*=(residue const& rhs);
+
+    friend bool operator==(residue const& a, residue const& b);
+    friend bool operator!=(residue const& a, residue const& b);
+
+private:
+    friend struct mod_context;
+
+    mod_context* context;
+    std::vector<uint32_t, big_integer_detail::limb_allocator> number;
+};
+
+residue operator+(residue a, residue const& b);
+residue operator-(residue a, residue const& b);
+residue operator*(residue a, residue const& b);
+
+bool operator==(residue const& a, residue const& b);
+bool operator!=(residue const& a, residue const& b);
@@ -1,11 +1,23 @@
 #include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <cstdlib>
 #include <string>
 #include <limits>
+#include <random>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 #include <gtest/gtest.h>
 
 #include "big_integer.h"
+#include "big_accumulator.h"
+#include "big_divisor.h"
+#include "big_integer_internal.h"
+#include "big_integer_kernels.h"
+#include "big_workspace.h"
+#include "constant_integer.h"
+#include "mod_context.h"
 
 TEST(correctness, two_plus_two)
 {
@@ -750,3 +762,984 @@ TEST(correctness, converting_ctor4)
     EXPECT_EQ(to_string(bignum), std::to_string(num));
 }
 
+
+TEST(correctness, batch_add_sub)
+{
+    big_integer a[] = {1, big_integer("-4294967296"), big_integer("18446744073709551615"), -7};
+    big_integer b[] = {2, -1, 1, big_integer("-340282366920938463463374607431768211456")};
+    big_integer r[4];
+
+    add_n(r, a, b, 4);
+    for (size_t i = 0; i != 4; ++i)
+    {
+        EXPECT_EQ(a[i] + b[i], r[i]);
+    }
+
+    sub_n(r, a, b, 4);
+    for (size_t i = 0; i != 4; ++i)
+    {
+        EXPECT_EQ(a[i] - b[i], r[i]);
+    }
+}
+
+TEST(correctness, batch_same_size)
+{
+    // blocks of short pairs go through the transposed addition, the tail and longer ones do not;
+    // the edge values put numbers of different lengths into one block
+    std::mt19937 rng(26);
+    big_integer edges[] = {0, -1, 1, big_integer(1) << 31, -(big_integer(1) << 31), (big_integer(1) << 32) - 1,
+                           -(big_integer(1) << 32), (big_integer(1) << 63) - 1, -(big_integer(1) << 63)};
+    for (size_t limbs = 1; limbs != 11; ++limbs)
+    {
+        std::vector<big_integer> a, b;
+        for (size_t i = 0; i != 45; ++i)
+        {
+            a.push_back(big_integer::random_bits(limbs * 32 - rng() % 2, rng));
+            b.push_back(big_integer::random_bits(limbs * 32 - rng() % 2, rng));
+            if (rng() % 2)
+                a.back() = -a.back();
+            if (rng() % 2)
+                b.back() = -b.back();
+        }
+        for (big_integer const& x : edges)
+        {
+            a.push_back(x);
+            b.push_back(edges[rng() % 9]);
+        }
+        std::vector<big_integer> r(a.size());
+        add_n(r.data(), a.data(), b.data(), a.size());
+        for (size_t i = 0; i != a.size(); ++i)
+            EXPECT_EQ(a[i] + b[i], r[i]);
+        sub_n(r.data(), a.data(), b.data(), a.size());
+        for (size_t i = 0; i != a.size(); ++i)
+            EXPECT_EQ(a[i] - b[i], r[i]);
+
+        std::vector<big_integer> c = a;
+        sub_n(c.data(), c.data(), b.data(), c.size());
+        add_n(c.data(), b.data(), c.data(), c.size());
+        for (size_t i = 0; i != a.size(); ++i)
+            EXPECT_EQ(a[i], c[i]);
+    }
+}
+
+TEST(correctness, batch_mul)
+{
+    big_integer a[] = {0, -1, big_integer("-4294967296"), big_integer("123456789012345678901234567890")};
+    big_integer b[] = {big_integer("-99999999999999999999"), -1, big_integer("-4294967296"), 3};
+    big_integer r[4];
+
+    mul_n(r, a, b, 4);
+    for (size_t i = 0; i != 4; ++i)
+    {
+        EXPECT_EQ(a[i] * b[i], r[i]);
+    }
+}
+
+TEST(correctness, batch_aliasing)
+{
+    big_integer a[] = {5, big_integer("-18446744073709551616")};
+    big_integer b[] = {-3, big_integer("18446744073709551617")};
+    big_integer expected[] = {a[0] * b[0] + b[0], a[1] * b[1] + b[1]};
+
+    mul_n(a, a, b, 2);
+    add_n(a, a, b, 2);
+
+    EXPECT_EQ(expected[0], a[0]);
+    EXPECT_EQ(expected[1], a[1]);
+}
+
+TEST(correctness, mul_karatsuba)
+{
+    big_integer a = (big_integer(1) << 5000) - 1;
+    big_integer b = (big_integer(1) << 3000) + 1;
+    big_integer expected = (big_integer(1) << 8000) + (big_integer(1) << 5000) - (big_integer(1) << 3000) - 1;
+
+    EXPECT_EQ(expected, a * b);
+    EXPECT_EQ(expected, b * a);
+    EXPECT_EQ(-expected, -a * b);
+    EXPECT_EQ((big_integer(1) << 10000) - (big_integer(1) << 5001) + 1, a * a);
+}
+
+TEST(correctness, product_sum)
+{
+    big_integer v[] = {3, big_integer("-100000000000000000000"), 7, big_integer("12345678901234567890123"), -1};
+
+    EXPECT_EQ(v[0] * v[1] * v[2] * v[3] * v[4], product(v, 5));
+    EXPECT_EQ(v[0] + v[1] + v[2] + v[3] + v[4], sum(v, 5));
+    EXPECT_EQ(1, product(v, 0));
+    EXPECT_EQ(0, sum(v, 0));
+}
+
+TEST(correctness, factorial_binomial)
+{
+    EXPECT_EQ(1, factorial(0));
+    EXPECT_EQ(1, factorial(1));
+    EXPECT_EQ(3628800, factorial(10));
+    EXPECT_EQ(big_integer("30414093201713378043612608166064768844377641568960512000000000000"), factorial(50));
+
+    big_integer f = 1;
+    for (int i = 2; i <= 500; i++)
+    {
+        f *= i;
+    }
+    EXPECT_EQ(f, factorial(500));
+
+    EXPECT_EQ(0, binomial(3, 4));
+    EXPECT_EQ(1, binomial(7, 0));
+    EXPECT_EQ(252, binomial(10, 5));
+    EXPECT_EQ(big_integer("100891344545564193334812497256"), binomial(100, 50));
+    EXPECT_EQ(factorial(300) / (factorial(120) * factorial(180)), binomial(300, 120));
+}
+
+TEST(correctness, divexact)
+{
+    big_integer a("1234567890123456789012345678901234567890");
+    big_integer b("-98765432109876543210987654321");
+
+    EXPECT_EQ(a, divexact(a * b, b));
+    EXPECT_EQ(-b, divexact(a * b, -a));
+    EXPECT_EQ(0, divexact(0, b));
+    EXPECT_EQ(big_integer(1) << 200, divexact(big_integer(1) << 300, big_integer(1) << 100));
+    EXPECT_EQ(-3, divexact(big_integer(-3) << 77, big_integer(1) << 77));
+}
+
+TEST(correctness, divisible_by)
+{
+    big_integer a("1234567890123456789012345678901234567890");
+    big_integer b("-98765432109876543210987654321");
+
+    EXPECT_TRUE(divisible_by(a * b, a));
+    EXPECT_TRUE(divisible_by(a * b, b));
+    EXPECT_FALSE(divisible_by(a * b + 1, b));
+    EXPECT_FALSE(divisible_by(a * b, b * 7));
+    EXPECT_TRUE(divisible_by(0, a));
+    EXPECT_FALSE(divisible_by(a, 0));
+    EXPECT_FALSE(divisible_by(b, a));
+    EXPECT_TRUE(divisible_by(big_integer(1) << 100, big_integer(1) << 64));
+    EXPECT_FALSE(divisible_by(big_integer(1) << 63, big_integer(1) << 64));
+    EXPECT_FALSE(divisible_by(big_integer(6) << 64, big_integer(4) << 64));
+}
+
+TEST(correctness, divmod)
+{
+    big_integer a("-1000000000000000000000000000007");
+    big_integer b("33333333333333333");
+
+    std::pair<big_integer, big_integer> qr = divmod(a, b);
+    EXPECT_EQ(a / b, qr.first);
+    EXPECT_EQ(a % b, qr.second);
+    EXPECT_EQ(a, qr.first * b + qr.second);
+
+    qr = divmod(7, -2);
+    EXPECT_EQ(-3, qr.first);
+    EXPECT_EQ(1, qr.second);
+
+    qr = divmod(3, 100);
+    EXPECT_EQ(0, qr.first);
+    EXPECT_EQ(3, qr.second);
+}
+
+TEST(correctness, divmod_floor)
+{
+    std::pair<big_integer, big_integer> qr = divmod_floor(7, -2);
+    EXPECT_EQ(-4, qr.first);
+    EXPECT_EQ(-1, qr.second);
+
+    qr = divmod_floor(-7, 2);
+    EXPECT_EQ(-4, qr.first);
+    EXPECT_EQ(1, qr.second);
+
+    qr = divmod_floor(-8, 2);
+    EXPECT_EQ(-4, qr.first);
+    EXPECT_EQ(0, qr.second);
+
+    big_integer a("-1000000000000000000000000000007");
+    big_integer b("33333333333333333");
+    qr = divmod_floor(a, b);
+    EXPECT_EQ(a, qr.first * b + qr.second);
+    EXPECT_GE(qr.second, 0);
+    EXPECT_LT(qr.second, b);
+}
+
+TEST(correctness, constant_literal)
+{
+    using namespace big_integer_literals;
+    constexpr auto a = 340282366920938463463374607431768211456_bi;
+    constexpr auto b = 0xFFFFFFFF'FFFFFFFF_bi;
+
+    static_assert(a - b * b == b + b + 1_bi, "computed at compile time");
+    static_assert(-a < b && b < a, "");
+    static_assert(constant_integer<2>("-18446744073709551615") == -b, "");
+
+    EXPECT_EQ(big_integer("340282366920938463463374607431768211456"), big_integer(a));
+    EXPECT_EQ(big_integer("-18446744073709551615"), big_integer(-b));
+    EXPECT_EQ(big_integer(a) * b, big_integer(a * b));
+    EXPECT_EQ(0, big_integer(b - b));
+    EXPECT_EQ(1'000'000, big_integer(1'000'000_bi));
+
+    // prefixes as for built-in literals
+    static_assert(0b1010_bi == 10_bi && 0B1'0000'0000_bi == 256_bi, "");
+    static_assert(017_bi == 15_bi && 0_bi == 0_bi && 00_bi == 0_bi, "");
+    static_assert(0xff_bi == 0XFF_bi && 0xff_bi == 255_bi, "");
+    EXPECT_EQ(big_integer(1) << 64, big_integer(0b1'0000000000000000000000000000000000000000000000000000000000000000_bi));
+    EXPECT_EQ(big_integer(1) << 63, big_integer(01000000000000000000000_bi));
+    EXPECT_EQ(big_integer(0777), big_integer(0777_bi));
+}
+
+TEST(correctness, constant_invalid)
+{
+    EXPECT_THROW(constant_integer<1>("4294967296"), std::overflow_error);
+    EXPECT_THROW(constant_integer<1>("12a"), std::invalid_argument);
+    EXPECT_THROW(constant_integer<1>("-"), std::invalid_argument);
+    EXPECT_THROW(constant_integer<1>(constant_integer<2>("4294967296")), std::overflow_error);
+
+    // digits the language rejects in a prefixed literal; in a constant expression they do not compile
+    using namespace big_integer_literals;
+    EXPECT_THROW((operator"" _bi<'0', '8'>()), std::invalid_argument);
+    EXPECT_THROW((operator"" _bi<'0', 'b', '1', '2'>()), std::invalid_argument);
+    EXPECT_THROW((operator"" _bi<'1', 'a'>()), std::invalid_argument);
+    EXPECT_THROW((operator"" _bi<'0', 'x', 'g'>()), std::invalid_argument);
+}
+
+TEST(correctness, kernels_match_portable)
+{
+    std::vector<limb_kernels> all = supported_kernels();
+    limb_kernels const& portable = all[0];
+    std::mt19937 rng(7);
+    for (limb_kernels const& k : all)
+    {
+        for (size_t n = 1; n != 40; ++n)
+        {
+            std::vector<uint32_t> a(n), b(n), r(n), expected(n);
+            std::generate(a.begin(), a.end(), std::ref(rng));
+            std::generate(b.begin(), b.end(), std::ref(rng));
+            uint32_t m = rng();
+            unsigned count = rng() % 31 + 1;
+
+            EXPECT_EQ(portable.add_n(expected.data(), a.data(), b.data(), n), k.add_n(r.data(), a.data(), b.data(), n)) << k.name;
+            EXPECT_EQ(expected, r) << k.name;
+            EXPECT_EQ(portable.sub_n(expected.data(), a.data(), b.data(), n), k.sub_n(r.data(), a.data(), b.data(), n)) << k.name;
+            EXPECT_EQ(expected, r) << k.name;
+            EXPECT_EQ(portable.mul_1(expected.data(), a.data(), n, m), k.mul_1(r.data(), a.data(), n, m)) << k.name;
+            EXPECT_EQ(expected, r) << k.name;
+            r = expected = b;
+            EXPECT_EQ(portable.addmul_1(expected.data(), a.data(), n, m), k.addmul_1(r.data(), a.data(), n, m)) << k.name;
+            EXPECT_EQ(expected, r) << k.name;
+            EXPECT_EQ(portable.submul_1(expected.data(), a.data(), n, m), k.submul_1(r.data(), a.data(), n, m)) << k.name;
+            EXPECT_EQ(expected, r) << k.name;
+            r = expected = a;
+            EXPECT_EQ(portable.lshift(expected.data(), expected.data(), n, count), k.lshift(r.data(), r.data(), n, count)) << k.name;
+            EXPECT_EQ(expected, r) << k.name;
+            portable.rshift(expected.data(), expected.data(), n, count);
+            k.rshift(r.data(), r.data(), n, count);
+            EXPECT_EQ(expected, r) << k.name;
+            // operator<<= shifts into its own limbs a few places up, operator>>= a few places down
+            for (size_t offset = 1; offset != 4; ++offset)
+            {
+                std::vector<uint32_t> up(n + offset), expected_up(n + offset);
+                std::generate(up.begin(), up.end(), std::ref(rng));
+                expected_up = up;
+                EXPECT_EQ(portable.lshift(expected_up.data() + offset, expected_up.data(), n, count),
+                          k.lshift(up.data() + offset, up.data(), n, count)) << k.name;
+                EXPECT_EQ(expected_up, up) << k.name;
+                std::generate(up.begin(), up.end(), std::ref(rng));
+                expected_up = up;
+                portable.rshift(expected_up.data(), expected_up.data() + offset, n, count);
+                k.rshift(up.data(), up.data() + offset, n, count);
+                EXPECT_EQ(expected_up, up) << k.name;
+            }
+            portable.and_n(expected.data(), a.data(), b.data(), n);
+            k.and_n(r.data(), a.data(), b.data(), n);
+            EXPECT_EQ(expected, r) << k.name;
+            portable.or_n(expected.data(), a.data(), b.data(), n);
+            k.or_n(r.data(), a.data(), b.data(), n);
+            EXPECT_EQ(expected, r) << k.name;
+            portable.xor_n(expected.data(), a.data(), b.data(), n);
+            k.xor_n(r.data(), a.data(), b.data(), n);
+            EXPECT_EQ(expected, r) << k.name;
+        }
+        for (size_t rows = 1; rows != 6; ++rows)
+        {
+            // all-ones limbs carry through every row
+            std::vector<uint32_t> a(8 * rows), b(8 * rows), r(8 * rows), expected(8 * rows);
+            for (size_t i = 0; i != a.size(); ++i)
+            {
+                a[i] = rng() % 3 == 0 ? ~0u : static_cast<uint32_t>(rng());
+                b[i] = rng() % 3 == 0 ? ~0u - a[i] : static_cast<uint32_t>(rng());
+            }
+            for (uint32_t carry : {0u, 1u})
+            {
+                portable.add_lanes(expected.data(), a.data(), b.data(), rows, carry);
+                k.add_lanes(r.data(), a.data(), b.data(), rows, carry);
+                EXPECT_EQ(expected, r) << k.name;
+                r = a;
+                k.add_lanes(r.data(), r.data(), b.data(), rows, carry);
+                EXPECT_EQ(expected, r) << k.name;
+            }
+        }
+    }
+}
+
+TEST(correctness, shifts_by_whole_limbs)
+{
+    big_integer a("-123456789012345678901234567890");
+    for (int shift = 0; shift < 200; shift += 16)
+    {
+        EXPECT_EQ(a, (a << shift) >> shift);
+        EXPECT_EQ(big_integer("-1") - (~a >> shift), a >> shift);
+    }
+    EXPECT_EQ(-1, a >> 1000);
+    EXPECT_EQ(0, -a >> 1000);
+}
+
+TEST(correctness, stats)
+{
+    big_integer a = big_integer(1) << 4000;
+    reset_big_integer_stats();
+
+    big_integer b = a;
+    big_integer c = a * b / 3;
+    big_integer d = a * 7 % b;
+
+    big_integer_stats stats = get_big_integer_stats();
+#ifdef BIG_INTEGER_STATS
+    EXPECT_GE(stats.copies, 1u);
+    EXPECT_GT(stats.allocations, 0u);
+    EXPECT_GE(stats.allocated_bytes, stats.allocations * sizeof(uint32_t));
+    EXPECT_EQ(1u, stats.karatsuba_multiplications);
+    EXPECT_EQ(1u, stats.basecase_multiplications);
+    EXPECT_EQ(2u, stats.divisions);
+    EXPECT_EQ(1u, stats.long_divisions);
+
+    reset_big_integer_stats();
+    EXPECT_EQ(0u, get_big_integer_stats().allocations);
+#else
+    EXPECT_EQ(0u, stats.allocations);
+    EXPECT_EQ(0u, stats.copies);
+    EXPECT_EQ(0u, stats.divisions);
+#endif
+}
+
+TEST(correctness, big_divisor)
+{
+    std::mt19937 rng(37);
+    auto random_number = [&rng](size_t limbs)
+    {
+        big_integer result;
+        for (size_t i = 0; i != limbs; ++i)
+            result = (result << 32) + big_integer(static_cast<uint32_t>(rng()));
+        return rng() % 2 ? -result : result;
+    };
+
+    for (size_t nb : {1, 2, 3, 7, 40, 200, 333, 700, 1500})
+    {
+        big_integer b = random_number(nb);
+        if (b == 0)
+            b = 1;
+        big_divisor d(b);
+        EXPECT_EQ(b, d.value());
+        for (size_t na : {size_t(0), nb - 1, nb, nb + 1, 2 * nb, 5 * nb + 3})
+        {
+            big_integer a = random_number(na);
+            EXPECT_EQ(a / b, a / d);
+            EXPECT_EQ(a % b, a % d);
+            std::pair<big_integer, big_integer> qr = divmod(a, d);
+            EXPECT_EQ(a / b, qr.first);
+            EXPECT_EQ(a % b, qr.second);
+            EXPECT_EQ(a, a / d * b + a % d);
+            EXPECT_EQ(b * 12345, b * 12345 / d * b);
+        }
+    }
+}
+
+TEST(correctness, big_divisor_edge_cases)
+{
+    EXPECT_THROW(big_divisor d(0), std::invalid_argument);
+    EXPECT_THROW(big_divisor d(-big_integer(1) + 1), std::invalid_argument);
+
+    // the Barrett constant of the longer ones comes from Newton iterations
+    for (int bits : {6400, 24000})
+    {
+        big_integer b = big_integer(1) << bits;
+        for (big_integer const& x : {b, -b, b - 1, -b + 1, b + 1, big_integer(-1), big_integer(1) << 31})
+        {
+            big_divisor d(x);
+            for (big_integer const& a : {big_integer(), x, -x, x * x - 1, -x * x + 1, x * x * x})
+            {
+                EXPECT_EQ(a / x, a / d);
+                EXPECT_EQ(a % x, a % d);
+            }
+            big_integer a = x * x + 5;
+            a /= d;
+            EXPECT_EQ(x + 5 / x, a);
+            a %= d;
+            EXPECT_EQ((x + 5 / x) % x, a);
+        }
+    }
+}
+
+TEST(correctness, big_accumulator)
+{
+    std::mt19937 rng(38);
+    big_integer expected;
+    big_accumulator sum;
+    EXPECT_EQ(0, sum.value());
+    for (int i = 0; i != 2000; ++i)
+    {
+        big_integer x;
+        for (uint32_t n = rng() % 20; n != 0; --n)
+            x = (x << 32) + big_integer(static_cast<uint32_t>(rng()));
+        if (rng() % 2)
+            x = -x;
+        if (rng() % 3)
+        {
+            sum += x;
+            expected += x;
+        }
+        else
+        {
+            sum -= x;
+            expected -= x;
+        }
+        if (i % 97 == 0)
+        {
+            EXPECT_EQ(expected, sum.value());
+        }
+    }
+    EXPECT_EQ(expected, sum.value());
+}
+
+TEST(correctness, big_accumulator_carries)
+{
+    big_integer all_ones = (big_integer(1) << 320) - 1;
+    big_accumulator sum(all_ones);
+    for (int i = 0; i != 1000; ++i)
+        sum += all_ones;
+    EXPECT_EQ(all_ones * 1001, sum.value());
+    for (int i = 0; i != 1002; ++i)
+        sum -= all_ones;
+    EXPECT_EQ(-all_ones, sum.value());
+    sum += all_ones;
+    EXPECT_EQ(0, sum.value());
+    sum -= big_integer(1);
+    EXPECT_EQ(-1, sum.value());
+}
+
+TEST(correctness, big_accumulator_normalize)
+{
+    // lanes carried in place every few additions, across signs and growing lengths
+    std::mt19937 rng(138);
+    for (uint32_t limit : {1u, 2u, 3u, 7u})
+    {
+        big_integer all_ones = (big_integer(1) << 320) - 1;
+        big_accumulator ones(all_ones, limit);
+        for (int i = 0; i != 100; ++i)
+            ones += all_ones;
+        EXPECT_EQ(all_ones * 101, ones.value());
+        for (int i = 0; i != 150; ++i)
+            ones -= all_ones;
+        EXPECT_EQ(all_ones * -49, ones.value());
+
+        big_integer expected;
+        big_accumulator sum(0, limit);
+        for (int i = 0; i != 500; ++i)
+        {
+            big_integer x = big_integer::random_bits(rng() % 700, rng);
+            if (rng() % 2)
+                x = -x;
+            if (rng() % 3)
+            {
+                sum += x;
+                expected += x;
+            }
+            else
+            {
+                sum -= x;
+                expected -= x;
+            }
+            if (i % 37 == 0)
+            {
+                EXPECT_EQ(expected, sum.value());
+            }
+        }
+        EXPECT_EQ(expected, sum.value());
+    }
+}
+
+TEST(correctness, random_bits)
+{
+    std::mt19937 rng(39);
+    EXPECT_EQ(0, big_integer::random_bits(0, rng));
+    for (size_t bits : {1, 5, 31, 32, 33, 64, 100, 1000})
+    {
+        big_integer bound = big_integer(1) << static_cast<int>(bits);
+        bool top_bit = false;
+        for (int i = 0; i != 100; ++i)
+        {
+            big_integer x = big_integer::random_bits(bits, rng);
+            EXPECT_LE(0, x);
+            EXPECT_LT(x, bound);
+            top_bit |= (x >> static_cast<int>(bits - 1)) == 1;
+        }
+        EXPECT_TRUE(top_bit);
+    }
+    std::mt19937 a(1), b(1);
+    EXPECT_EQ(big_integer::random_bits(500, a), big_integer::random_bits(500, b));
+}
+
+TEST(correctness, random_below)
+{
+    std::minstd_rand rng(39);
+    std::vector<int> hits(10);
+    for (int i = 0; i != 10000; ++i)
+        hits[std::stoi(to_string(big_integer::random_below(10, rng)))]++;
+    for (int h : hits)
+    {
+        EXPECT_GT(h, 800);
+        EXPECT_LT(h, 1200);
+    }
+
+    std::mt19937_64 rng64(39);
+    for (big_integer bound : {big_integer(1), big_integer(1) << 32, (big_integer(1) << 32) + 1,
+                              big_integer("123456789012345678901234567890"), (big_integer(1) << 1000) - 1})
+    {
+        for (int i = 0; i != 100; ++i)
+        {
+            big_integer x = big_integer::random_below(bound, rng64);
+            EXPECT_LE(0, x);
+            EXPECT_LT(x, bound);
+        }
+    }
+    EXPECT_THROW(big_integer::random_below(0, rng), std::invalid_argument);
+    EXPECT_THROW(big_integer::random_below(-5, rng), std::invalid_argument);
+}
+
+TEST(correctness, pow_mod)
+{
+    EXPECT_EQ(4, pow_mod(2, 10, 1020));
+    EXPECT_EQ(1, pow_mod(7, 0, 13));
+    EXPECT_EQ(0, pow_mod(7, 0, 1));
+    EXPECT_EQ(10, pow_mod(-3, 3, 37));
+    EXPECT_EQ(1, pow_mod(3, big_integer(1) << 100, 4));
+    EXPECT_EQ(3, pow_mod(3, (big_integer(1) << 100) + 1, 12));
+
+    std::mt19937 rng(40);
+    for (size_t bits : {30, 64, 200, 1100, 3000})
+    {
+        big_integer m = big_integer::random_bits(bits, rng) + 1;
+        big_integer a = big_integer::random_bits(bits + 20, rng);
+        big_integer expected = 1;
+        for (int e = 0; e != 40; ++e)
+        {
+            EXPECT_EQ(expected, pow_mod(a, e, m));
+            expected = expected * a % m;
+        }
+        EXPECT_EQ(pow_mod(a, 12345, m) * pow_mod(a, 54321, m) % m, pow_mod(a, 66666, m));
+    }
+    EXPECT_THROW(pow_mod(2, 3, 0), std::invalid_argument);
+    EXPECT_THROW(pow_mod(2, -3, 5), std::invalid_argument);
+}
+
+TEST(correctness, is_probable_prime)
+{
+    std::vector<bool> sieve(20000, true);
+    for (int i = 2; i < 20000; ++i)
+    {
+        EXPECT_EQ(sieve[i], is_probable_prime(i)) << i;
+        for (int j = 2 * i; sieve[i] && j < 20000; j += i)
+            sieve[j] = false;
+    }
+    EXPECT_FALSE(is_probable_prime(0));
+    EXPECT_FALSE(is_probable_prime(1));
+    EXPECT_FALSE(is_probable_prime(-7));
+
+    // strong pseudoprimes to base 2, strong Lucas pseudoprimes and Carmichael numbers
+    for (char const* composite : {"2047", "3277", "4033", "4681", "8321", "5459", "5777", "10877", "16109", "561",
+                                  "41041", "825265", "3215031751", "3825123056546413051", "318665857834031151167461",
+                                  "1000000016000000063"})
+    {
+        EXPECT_FALSE(is_probable_prime(big_integer(composite))) << composite;
+    }
+
+    big_integer mersenne_521 = (big_integer(1) << 521) - 1;
+    EXPECT_TRUE(is_probable_prime(mersenne_521));
+    EXPECT_TRUE(is_probable_prime((big_integer(1) << 127) - 1));
+    EXPECT_TRUE(is_probable_prime(big_integer("18446744073709551557")));
+    EXPECT_FALSE(is_probable_prime((big_integer(1) << 523) - 1));
+    EXPECT_FALSE(is_probable_prime(mersenne_521 * mersenne_521));
+    EXPECT_FALSE(is_probable_prime(mersenne_521 * ((big_integer(1) << 607) - 1)));
+}
+
+TEST(correctness, next_prime)
+{
+    EXPECT_EQ(2, next_prime(-10));
+    EXPECT_EQ(2, next_prime(1));
+    EXPECT_EQ(3, next_prime(2));
+    EXPECT_EQ(997, next_prime(996));
+    EXPECT_EQ(1009, next_prime(997));
+    EXPECT_EQ(big_integer("18446744073709551629"), next_prime(big_integer(1) << 64));
+    EXPECT_EQ(big_integer("100000000000000000039"), next_prime(big_integer("100000000000000000000")));
+    EXPECT_EQ((big_integer(1) << 521) - 271, next_prime((big_integer(1) << 521) - 300));
+    EXPECT_EQ((big_integer(1) << 521) - 1, next_prime((big_integer(1) << 521) - 115));
+}
+
+TEST(correctness, copy_on_write)
+{
+    big_integer const original = (big_integer(1) << 3000) - 12345;
+    std::vector<big_integer> copies(12, original);
+    copies[0] += 1;
+    copies[1] -= 1;
+    copies[2] *= 3;
+    copies[3] /= 7;
+    copies[4] %= 7;
+    copies[5] <<= 40;
+    copies[6] >>= 40;
+    copies[7] &= 0xFFFF;
+    copies[8] |= 1;
+    copies[9] ^= original;
+    ++copies[10];
+    copies[11].abs();
+    copies[11] = -copies[11];
+
+    EXPECT_EQ((big_integer(1) << 3000) - 12345, original);
+    EXPECT_EQ(original + 1, copies[0]);
+    EXPECT_EQ(original - 1, copies[1]);
+    EXPECT_EQ(original * 3, copies[2]);
+    EXPECT_EQ(original / 7, copies[3]);
+    EXPECT_EQ(original % 7, copies[4]);
+    EXPECT_EQ(original * (big_integer(1) << 40), copies[5]);
+    EXPECT_EQ(original / (big_integer(1) << 40), copies[6]);
+    EXPECT_EQ(original % 0x10000, copies[7]);
+    EXPECT_EQ(original, copies[8]);
+    EXPECT_EQ(0, copies[9]);
+    EXPECT_EQ(original + 1, copies[10]);
+    EXPECT_EQ(-original, copies[11]);
+
+    big_integer a = original;
+    big_integer b = a;
+    a *= a;
+    b += b;
+    EXPECT_EQ(original * original, a);
+    EXPECT_EQ(original * 2, b);
+
+    big_integer d;
+    reset_big_integer_stats();
+    big_integer c = original;
+    d = c;
+    EXPECT_EQ(0u, get_big_integer_stats().allocations);
+    EXPECT_EQ(c, d);
+}
+
+TEST(correctness, hash)
+{
+    std::hash<big_integer> hash;
+    big_integer a = (big_integer(1) << 1000) - 5;
+    EXPECT_EQ(hash(a), hash((big_integer(1) << 1000) - 5));
+    EXPECT_EQ(hash(big_integer(123)), hash(big_integer("123")));
+    EXPECT_EQ(hash(big_integer(0)), hash(big_integer("-0")));
+    EXPECT_EQ(hash(big_integer(-1)), hash(big_integer(0xFFFFFFFFu) - big_integer(0x100000000ull)));
+    EXPECT_NE(hash(big_integer(1)), hash(big_integer(-1)));
+    EXPECT_NE(hash(a), hash(-a));
+
+    std::unordered_set<size_t> hashes;
+    for (int i = -5000; i != 5000; ++i)
+    {
+        hashes.insert(hash(i));
+        hashes.insert(hash(a + i));
+        hashes.insert(hash(a << (i + 5000) % 200));
+    }
+    // 10000 + 10000 + 200 values, a itself counted twice
+    EXPECT_EQ(20199u, hashes.size());
+
+    std::unordered_map<big_integer, int> map;
+    for (int i = 0; i != 100; ++i)
+        map[a * i] = i;
+    EXPECT_EQ(100u, map.size());
+    EXPECT_EQ(42, map.at(a * 42));
+    EXPECT_EQ(0u, map.count(a * 100));
+}
+
+TEST(correctness, to_double)
+{
+    big_integer one = 1;
+    EXPECT_EQ(0.0, to_double(0));
+    std::mt19937_64 rng(43);
+    for (int i = 0; i != 10000; ++i)
+    {
+        long long v = static_cast<long long>(rng()) >> (rng() % 64);
+        EXPECT_EQ(static_cast<double>(v), to_double(v));
+        EXPECT_EQ(static_cast<long double>(v), to_long_double(v));
+    }
+
+    // halfway between two doubles the even mantissa wins, anything below the halfway bit breaks the tie
+    EXPECT_EQ(std::ldexp(1.0, 153), to_double(((one << 53) + 1) << 100));
+    EXPECT_EQ(std::ldexp(double((1LL << 53) + 4), 100), to_double(((one << 53) + 3) << 100));
+    EXPECT_EQ(std::ldexp(double((1LL << 53) + 2), 1000), to_double((((one << 53) + 1) << 1000) + 1));
+    EXPECT_EQ(-std::ldexp(double((1LL << 53) + 2), 1000), to_double(-(((one << 53) + 1) << 1000) - 1));
+    EXPECT_EQ(-std::ldexp(1.0, 64), to_double(-(one << 64)));
+    EXPECT_EQ(-std::ldexp(1.0, 64), to_double(-(one << 64) + 1));
+
+    double const max = std::numeric_limits<double>::max();
+    double const inf = std::numeric_limits<double>::infinity();
+    big_integer exact_max = ((one << 53) - 1) << 971;
+    EXPECT_EQ(max, to_double(exact_max));
+    EXPECT_EQ(max, to_double(exact_max + (one << 970) - 1));
+    EXPECT_EQ(inf, to_double(exact_max + (one << 970)));
+    EXPECT_EQ(-inf, to_double(-(one << 100000)));
+
+    // strtod rounds correctly, so the decimal string is the reference
+    for (int i = 0; i != 2000; ++i)
+    {
+        big_integer x = big_integer::random_bits(rng() % 1020 + 1, rng);
+        if (i % 2 == 0)
+            x = ((x >> 960) | (one << 53) | 1) << (rng() % 960);
+        if (i % 3 == 0)
+            x = -x;
+        std::string s = to_string(x);
+        EXPECT_EQ(std::stod(s), to_double(x)) << s;
+        EXPECT_EQ(std::stold(s), to_long_double(x)) << s;
+    }
+}
+
+TEST(correctness, frexp)
+{
+    big_integer one = 1;
+    long e;
+    EXPECT_EQ(0.75, frexp(3, &e));
+    EXPECT_EQ(2, e);
+    EXPECT_EQ(0.0, frexp(0, &e));
+    EXPECT_EQ(0, e);
+    EXPECT_EQ(-0.5, frexp(-(one << 5000), &e));
+    EXPECT_EQ(5001, e);
+    EXPECT_EQ(0.5, frexp((one << 5000) - 1, &e));
+    EXPECT_EQ(5001, e);
+    EXPECT_EQ(std::ldexp(double((1LL << 53) - 1), -53), frexp(((one << 53) - 1) << 3000, &e));
+    EXPECT_EQ(3053, e);
+}
+
+TEST(correctness, from_double)
+{
+    EXPECT_EQ(0, big_integer(0.0));
+    EXPECT_EQ(0, big_integer(-0.0));
+    EXPECT_EQ(0, big_integer(0.99));
+    EXPECT_EQ(-2, big_integer(-2.7));
+    EXPECT_EQ(big_integer(1000000000000000000LL), big_integer(1e18));
+    EXPECT_EQ(big_integer("100000000000000005250476025520442024870446858110815915491585411551180245798890819578637137"
+                          "508044786404370444383288387817694252323536043057564479218478670698284838720092657580373783"
+                          "023379478809005936895323497079994508111903896764088007465274278014249457925878882005684283"
+                          "8115669472196386865459400540160"),
+              big_integer(1e300));
+    EXPECT_EQ(-(big_integer(1) << 1023), big_integer(-std::ldexp(1.0, 1023)));
+    EXPECT_EQ(((big_integer(1) << 53) - 1) << 971, big_integer(std::numeric_limits<double>::max()));
+    EXPECT_EQ(big_integer(3) << 1000, big_integer(std::ldexp(3.0L, 1000)));
+    EXPECT_EQ(-12345, big_integer(-12345.75L));
+
+    std::mt19937_64 rng(44);
+    for (int i = 0; i != 1000; ++i)
+    {
+        big_integer x = big_integer::random_bits(rng() % 1000 + 1, rng);
+        double d = to_double(i % 2 == 0 ? x : -x);
+        EXPECT_EQ(d, to_double(big_integer(d)));
+    }
+
+    EXPECT_THROW(big_integer(std::numeric_limits<double>::infinity()), std::invalid_argument);
+    EXPECT_THROW(big_integer(-std::numeric_limits<long double>::infinity()), std::invalid_argument);
+    EXPECT_THROW(big_integer(std::numeric_limits<double>::quiet_NaN()), std::invalid_argument);
+}
+
+TEST(correctness, mod_context)
+{
+    std::mt19937_64 rng(45);
+    for (big_integer m : {big_integer(3), big_integer(1000000007), (big_integer(1) << 127) - 1,
+                          next_prime(big_integer::random_bits(1500, rng)), big_integer::random_bits(3000, rng) | 1})
+    {
+        mod_context context(m);
+        EXPECT_EQ(m, context.modulus());
+        for (int i = 0; i != 20; ++i)
+        {
+            big_integer x = big_integer::random_bits(3100, rng) - big_integer::random_bits(3100, rng);
+            big_integer y = big_integer::random_below(m, rng);
+            big_integer e = big_integer::random_bits(rng() % 300, rng);
+            residue a(context, x);
+            residue b(context, y);
+            big_integer xm = divmod_floor(x, m).second;
+
+            EXPECT_EQ(xm, a.value());
+            EXPECT_EQ((xm + y) % m, (a + b).value());
+            EXPECT_EQ(divmod_floor(xm - y, m).second, (a - b).value());
+            EXPECT_EQ(xm * y % m, (a * b).value());
+            residue r(context);
+            context.pow(r, a, e);
+            EXPECT_EQ(pow_mod(x, e, m), r.value());
+            if (xm != 0 && is_probable_prime(m))
+            {
+                context.inverse(r, a);
+                EXPECT_EQ(1, (r * a).value());
+            }
+        }
+    }
+
+    mod_context context(15);
+    residue a(context, 6);
+    residue r(context);
+    EXPECT_THROW(context.inverse(r, a), std::invalid_argument);
+    EXPECT_THROW(context.inverse(r, residue(context)), std::invalid_argument);
+    context.inverse(r, residue(context, 7));
+    EXPECT_EQ(13, r.value());
+    EXPECT_EQ(residue(context, -8), residue(context, 7));
+    EXPECT_NE(residue(context, 8), residue(context, 7));
+    EXPECT_THROW(context.pow(r, a, -1), std::invalid_argument);
+    EXPECT_THROW(mod_context(16), std::invalid_argument);
+    EXPECT_THROW(mod_context(1), std::invalid_argument);
+    EXPECT_THROW(mod_context(-7), std::invalid_argument);
+}
+
+TEST(correctness, mod_context_steady_state)
+{
+    std::mt19937_64 rng(46);
+    big_integer m = big_integer::random_bits(2048, rng) | 1;
+    big_integer e = big_integer::random_bits(2048, rng);
+    mod_context context(m);
+    residue a(context, big_integer::random_below(m, rng));
+    residue b(context, big_integer::random_below(m, rng));
+    residue r(context);
+    context.pow(r, a, e);
+
+    reset_big_integer_stats();
+    for (int i = 0; i != 10; ++i)
+    {
+        a *= b;
+        a += r;
+        b -= a;
+        context.pow(r, a, e);
+        context.inverse(b, r);
+    }
+    EXPECT_EQ(0u, get_big_integer_stats().allocations);
+    EXPECT_EQ(1, (b * r).value());
+}
+
+TEST(correctness, long_strings)
+{
+    // powers of ten and their neighbours at the leaf and the first split sizes of the conversion
+    big_integer ten = 1;
+    std::string zeros;
+    for (int i = 0; i != 1200; ++i)
+    {
+        EXPECT_EQ("1" + zeros, to_string(ten));
+        EXPECT_EQ("-1" + zeros, to_string(-ten));
+        if (i != 0)
+        {
+            EXPECT_EQ(std::string(i, '9'), to_string(ten - 1));
+        }
+        ten *= 10;
+        zeros += '0';
+    }
+
+    std::mt19937_64 rng(47);
+    for (size_t bits : {5000u, 40000u, 150000u, 400000u})
+    {
+        big_integer x = big_integer::random_bits(bits, rng) | (big_integer(1) << static_cast<int>(bits - 1));
+        std::string s = to_string(x);
+        EXPECT_EQ(x, big_integer(s));
+        EXPECT_EQ("-" + s, to_string(-x));
+
+        std::string digits(s.size(), '0');
+        digits[0] = '1';
+        for (size_t i = 1; i < digits.size(); i += rng() % 400 + 1)
+            digits[i] = static_cast<char>('0' + rng() % 10);
+        EXPECT_EQ(digits, to_string(big_integer(digits)));
+    }
+}
+
+TEST(correctness, long_strings_threads)
+{
+    // the subtrees above parallel_digits go to other threads whatever the machine has
+    std::mt19937 rng(47);
+    for (size_t bits : {150000u, 400000u})
+    {
+        big_integer x = big_integer::random_bits(bits, rng) | (big_integer(1) << static_cast<int>(bits - 1));
+        std::string s = big_integer_detail::to_string(x, 1);
+        EXPECT_EQ(x, big_integer(s));
+        for (unsigned n : {2u, 3u, 8u})
+        {
+            EXPECT_EQ(s, big_integer_detail::to_string(x, n));
+            EXPECT_EQ("-" + s, big_integer_detail::to_string(-x, n));
+        }
+    }
+}
+
+TEST(correctness, workspace)
+{
+    std::mt19937_64 rng(48);
+    big_workspace w;
+    big_integer q;
+    big_integer r;
+    std::string s;
+    for (int i = 0; i != 300; ++i)
+    {
+        big_integer a = big_integer::random_bits(rng() % 12000 + 1, rng);
+        big_integer b = big_integer::random_bits(rng() % 7000 + 1, rng) + 1;
+        if (rng() % 2 == 0)
+            a = -a;
+        if (rng() % 2 == 0)
+            b = -b;
+
+        w.mul(r, a, b);
+        EXPECT_EQ(a * b, r);
+        w.divmod(q, r, a, b);
+        EXPECT_EQ(a / b, q);
+        EXPECT_EQ(a % b, r);
+        big_divisor d(b);
+        w.divmod(q, r, a, d);
+        EXPECT_EQ(a / b, q);
+        EXPECT_EQ(a % b, r);
+        w.to_string(s, i % 3 == 0 ? a >> 10000 : a);
+        EXPECT_EQ(to_string(i % 3 == 0 ? a >> 10000 : a), s);
+
+        // results in place of the operands
+        big_integer c = a;
+        w.mul(c, c, c);
+        EXPECT_EQ(a * a, c);
+        c = a;
+        w.div(c, c, b);
+        EXPECT_EQ(a / b, c);
+        c = a;
+        w.mod(c, c, d);
+        EXPECT_EQ(a % b, c);
+        c = b;
+        w.mod(c, a, c);
+        EXPECT_EQ(a % b, c);
+    }
+    w.to_string(s, 0);
+    EXPECT_EQ("0", s);
+    w.to_string(s, -1000000000);
+    EXPECT_EQ("-1000000000", s);
+}
+
+TEST(correctness, workspace_steady_state)
+{
+    std::mt19937_64 rng(49);
+    big_integer one = 1;
+    big_integer a = big_integer::random_bits(4000, rng) | one << 3999;
+    big_integer b[] = {big_integer::random_bits(2500, rng) | one << 2499, big_integer::random_bits(2500, rng)};
+    big_integer c[] = {big_integer::random_bits(1500, rng), -big_integer::random_bits(1500, rng)};
+    big_divisor d(big_integer::random_bits(7000, rng) | one << 6999);
+    big_workspace w;
+    big_integer p;
+    big_integer q;
+    big_integer r;
+    std::string s;
+    for (int i = 0; i != 102; ++i)
+    {
+        if (i == 2)
+            reset_big_integer_stats();
+        w.mul(p, a, b[i % 2]);
+        w.divmod(q, r, p, a);
+        w.mod(r, p, b[i % 2]);
+        w.divmod(q, r, p, d);
+        w.div(q, p, d);
+        w.to_string(s, c[i % 2]);
+    }
+    EXPECT_EQ(0u, get_big_integer_stats().allocations);
+    EXPECT_EQ(to_string(c[1]), s);
+}
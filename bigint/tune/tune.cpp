@@ -0,0 +1,149 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../big_divisor.h"
+#include "../big_integer.h"
+
+// the tuned copy of big_integer.cpp (built with BIG_INTEGER_TUNE) keeps its thresholds in these variables
+extern size_t karatsuba_threshold;
+extern size_t barrett_threshold;
+
+namespace
+{
+    constexpr size_t NEVER = std::numeric_limits<size_t>::max();
+
+    std::mt19937 rng(42);
+
+    // exactly n limbs
+    big_integer random_number(size_t n)
+    {
+        return big_integer::random_bits(32 * n - 1, rng) + (big_integer(1) << static_cast<int>(32 * n - 1));
+    }
+
+    // best of several runs, each long enough for the clock resolution not to matter
+    double seconds(std::function<void()> const& f)
+    {
+        using clock = std::chrono::steady_clock;
+        size_t iterations = 1;
+        double best = std::numeric_limits<double>::max();
+        for (int run = 0; run < 7;)
+        {
+            auto start = clock::now();
+            for (size_t i = 0; i < iterations; i++)
+                f();
+            double elapsed = std::chrono::duration<double>(clock::now() - start).count();
+            if (elapsed < 2e-3)
+            {
+                iterations *= 2;
+                continue;
+            }
+            best = std::min(best, elapsed / static_cast<double>(iterations));
+            run++;
+        }
+        return best;
+    }
+
+    struct threshold
+    {
+        char const* name;
+        size_t& value;
+        // operation on operands of n limbs whose algorithm switches at value; it is built after value
+        // is set, so precomputation done up front (like in big_divisor) follows the threshold too
+        std::function<std::function<void()>(size_t)> operation;
+        size_t min;
+        size_t max;
+    };
+
+    // smallest size from which the faster algorithm wins three sizes in a row, like GMP's tuneup,
+    // or NEVER if it does not within the range: at size n the threshold is set to n, so only the
+    // top level uses the new algorithm
+    size_t find_threshold(threshold& t)
+    {
+        size_t found = NEVER;
+        int wins = 0;
+        for (size_t n = t.min; n <= t.max; n += std::max<size_t>(1, n / 16))
+        {
+            t.value = NEVER;
+            rng.seed(static_cast<uint32_t>(n));
+            double old_time = seconds(t.operation(n));
+            t.value = n;
+            rng.seed(static_cast<uint32_t>(n));
+            double new_time = seconds(t.operation(n));
+            std::cerr << t.name << " " << n << ": " << old_time * 1e6 << " us -> " << new_time * 1e6 << " us\n";
+            if (new_time < old_time)
+            {
+                if (wins++ == 0)
+                    found = n;
+                if (wins == 3)
+                    return found;
+            }
+            else
+            {
+                wins = 0;
+            }
+        }
+        return NEVER;
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::vector<threshold> thresholds = {
+        {"KARATSUBA_THRESHOLD", karatsuba_threshold,
+         [](size_t n) {
+             big_integer a = random_number(n);
+             big_integer b = random_number(n);
+             return std::function<void()>([a, b] { big_integer r = a * b; });
+         },
+         8, 256},
+        {"BARRETT_THRESHOLD", barrett_threshold,
+         [](size_t n) {
+             big_integer a = random_number(2 * n);
+             big_divisor d(random_number(n));
+             return std::function<void()>([a, d] { big_integer q = a / d; });
+         },
+         16, 1024},
+    };
+
+    std::ostringstream header;
+    header << "#pragma once\n\n"
+           << "// Algorithm crossover points in 32-bit limbs measured by bigint-tune on this machine,\n"
+           << "// ahead of the defaults in big_integer_thresholds.h. SIZE_MAX: the algorithm never won.\n\n"
+           << "#include <cstdint>\n";
+    for (threshold& t : thresholds)
+    {
+        t.value = find_threshold(t);
+        header << "\n#ifndef " << t.name << "\n#define " << t.name << " ";
+        if (t.value == NEVER)
+            header << "SIZE_MAX";
+        else
+            header << t.value;
+        header << "\n#endif\n";
+    }
+
+    if (argc > 1)
+    {
+        std::ofstream out(argv[1]);
+        out << header.str();
+        if (!out)
+        {
+            std::cerr << "cannot write " << argv[1] << "\n";
+            return 1;
+        }
+    }
+    else
+    {
+        std::cout << header.str();
+    }
+    return 0;
+}
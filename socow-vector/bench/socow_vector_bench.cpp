@@ -0,0 +1,83 @@
+#include <cstddef>
+#include <benchmark/benchmark.h>
+
+#include "../socow-vector.h"
+
+namespace {
+    template <typename RefCount>
+    using vector = socow_vector<int, 4, RefCount>;
+
+    template <typename RefCount>
+    vector<RefCount> filled(size_t n) {
+        vector<RefCount> a;
+        for (size_t i = 0; i != n; ++i) {
+            a.push_back(static_cast<int>(i));
+        }
+        return a;
+    }
+
+    // a copy shares the buffer and its destruction drops the reference
+    template <typename RefCount>
+    void copy(benchmark::State& state) {
+        vector<RefCount> a = filled<RefCount>(100);
+        for (auto _ : state) {
+            vector<RefCount> b = a;
+            benchmark::DoNotOptimize(b);
+        }
+    }
+
+    // every thread copies the same vector, so the counter bounces between the cores
+    template <typename RefCount>
+    void copy_shared(benchmark::State& state) {
+        static vector<RefCount> a = filled<RefCount>(100);
+        for (auto _ : state) {
+            vector<RefCount> b = a;
+            benchmark::DoNotOptimize(b);
+        }
+    }
+
+    // a write to a copy makes its own buffer
+    template <typename RefCount>
+    void unshare(benchmark::State& state) {
+        vector<RefCount> a = filled<RefCount>(state.range(0));
+        for (auto _ : state) {
+            vector<RefCount> b = a;
+            b[0] = 1;
+            benchmark::DoNotOptimize(b.data());
+        }
+    }
+
+    // a non-const access checks that the buffer is not shared
+    template <typename RefCount>
+    void write_unique(benchmark::State& state) {
+        vector<RefCount> a = filled<RefCount>(state.range(0));
+        for (auto _ : state) {
+            for (size_t i = 0; i != a.size(); ++i) {
+                a[i]++;
+            }
+            benchmark::ClobberMemory();
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    template <typename RefCount>
+    void push_back(benchmark::State& state) {
+        for (auto _ : state) {
+            vector<RefCount> a = filled<RefCount>(state.range(0));
+            benchmark::DoNotOptimize(a.data());
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+}
+
+BENCHMARK_TEMPLATE(copy, socow_plain_refcount);
+BENCHMARK_TEMPLATE(copy, socow_atomic_refcount);
+BENCHMARK_TEMPLATE(copy_shared, socow_atomic_refcount)->ThreadRange(1, 4);
+BENCHMARK_TEMPLATE(unshare, socow_plain_refcount)->Arg(16)->Arg(1024);
+BENCHMARK_TEMPLATE(unshare, socow_atomic_refcount)->Arg(16)->Arg(1024);
+BENCHMARK_TEMPLATE(write_unique, socow_plain_refcount)->Arg(1024);
+BENCHMARK_TEMPLATE(write_unique, socow_atomic_refcount)->Arg(1024);
+BENCHMARK_TEMPLATE(push_back, socow_plain_refcount)->Arg(1024);
+BENCHMARK_TEMPLATE(push_back, socow_atomic_refcount)->Arg(1024);
+
+BENCHMARK_MAIN();
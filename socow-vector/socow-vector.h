@@ -1,7 +1,51 @@
 #pragma once
+#include <atomic>
 #include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
 
-template <typename T, size_t SMALL_SIZE>
+// Reference counters for the heap buffer of socow_vector. The plain one is the default. With the
+// atomic one, copies of a vector sharing a buffer may be made, read, modified and destroyed on
+// different threads, as long as each vector object is used by one thread at a time: whoever drops
+// the last reference destroys the elements, and a vector that finds itself the only owner sees
+// every write the previous owners made before letting go.
+struct socow_plain_refcount {
+    explicit socow_plain_refcount(size_t value) : value(value) {}
+
+    void increment() {
+        value++;
+    }
+    // true when the last reference is gone
+    bool decrement() {
+        return --value == 0;
+    }
+    bool unique() const {
+        return value == 1;
+    }
+
+private:
+    size_t value;
+};
+
+struct socow_atomic_refcount {
+    explicit socow_atomic_refcount(size_t value) : value(value) {}
+
+    void increment() {
+        value.fetch_add(1, std::memory_order_relaxed);
+    }
+    bool decrement() {
+        return value.fetch_sub(1, std::memory_order_acq_rel) == 1;
+    }
+    bool unique() const {
+        return value.load(std::memory_order_acquire) == 1;
+    }
+
+private:
+    std::atomic<size_t> value;
+};
+
+template <typename T, size_t SMALL_SIZE, typename RefCount = socow_plain_refcount>
 struct socow_vector {
     using iterator = T*;
     using const_iterator = T const*;
@@ -18,6 +62,20 @@ struct socow_vector {
         }
     }
 
+    // takes the buffer of a big other and moves the elements of a small one, leaving other empty
+    socow_vector(socow_vector&& other) noexcept(std::is_nothrow_move_constructible<T>::value) :
+          size_(other.size_), small(other.small) {
+        if (other.small) {
+            move_range(other.static_storage, static_storage, other.size_);
+            destruct_range(other.static_storage, other.static_storage + other.size_);
+        } else {
+            new(&dynamic_storage) dynamic_buffer(std::move(other.dynamic_storage));
+            other.dynamic_storage.~dynamic_buffer();
+            other.small = true;
+        }
+        other.size_ = 0;
+    }
+
     socow_vector& operator=(socow_vector const& other) {
         if (this != &other) {
             socow_vector t(other);
@@ -26,13 +84,20 @@ struct socow_vector {
         return *this;
     }
 
+    socow_vector& operator=(socow_vector&& other) noexcept(std::is_nothrow_move_constructible<T>::value &&
+                                                           std::is_nothrow_move_assignable<T>::value) {
+        if (this != &other) {
+            socow_vector t(std::move(other));
+            t.swap(*this);
+        }
+        return *this;
+    }
+
     ~socow_vector() {
         if (small) {
             destruct_range(current_begin(), current_end());
         } else {
-            if (dynamic_storage.unique()) {
-                destruct_range(current_begin(), current_end());
-            }
+            dynamic_storage.release(size_);
             dynamic_storage.~dynamic_buffer();
         }
     }
@@ -70,14 +135,30 @@ struct socow_vector {
     }
 
     void push_back(T const& t) {
+        emplace_back(t);
+    }
+    void push_back(T&& t) {
+        emplace_back(std::move(t));
+    }
+
+    // args may refer to an element of the vector: on a full buffer the new element is constructed
+    // in the new buffer before the old elements move there
+    template <typename... Args>
+    T& emplace_back(Args&&... args) {
         if (capacity() == size_) {
-            T t_tmp = t;
-            extend_buffer(capacity() * 2, begin(), size_);
-            new (begin() + size_) T(t_tmp);
+            dynamic_buffer tmp(capacity() * 2);
+            new (tmp.get() + size_) T(std::forward<Args>(args)...);
+            try {
+                relocate(tmp);
+            } catch (...) {
+                tmp.get()[size_].~T();
+                throw;
+            }
+            replace_buffer(tmp);
         } else {
-            new (begin() + size_) T(t);
+            new (begin() + size_) T(std::forward<Args>(args)...);
         }
-        size_++;
+        return current_begin()[size_++];
     }
     void pop_back() {
         (end() - 1)->~T();
@@ -96,26 +177,31 @@ struct socow_vector {
     }
     void reserve(size_t new_cap) {
         if ((small && new_cap > SMALL_SIZE) || (!small && new_cap > capacity())) {
-            extend_buffer(new_cap, current_begin(), size_);
+            extend_buffer(new_cap);
         } else if (!small && !dynamic_storage.unique()) {
-            extend_buffer(capacity(), current_begin(), size_);
+            extend_buffer(capacity());
         }
     }
     void shrink_to_fit() {
         if (!small) {
             if (size_ <= SMALL_SIZE) {
-                dynamic_buffer tmp = dynamic_storage;
+                bool unique = dynamic_storage.unique();
+                dynamic_buffer tmp(std::move(dynamic_storage));
                 dynamic_storage.~dynamic_buffer();
                 try {
-                    copy_range(tmp.get(), static_storage, size_);
+                    if (unique) {
+                        move_range(tmp.get(), static_storage, size_);
+                    } else {
+                        copy_range(tmp.get(), static_storage, size_);
+                    }
                 } catch (...) {
-                    new(&dynamic_storage) dynamic_buffer(tmp);
+                    new(&dynamic_storage) dynamic_buffer(std::move(tmp));
                     throw;
                 }
-                destruct_range(tmp.get(), tmp.get() + size_);
+                tmp.release(size_);
                 small = true;
             } else if (size_ != capacity()) {
-                extend_buffer(size_, dynamic_storage.get(), size_);
+                extend_buffer(size_);
             }
         }
     }
@@ -124,15 +210,17 @@ struct socow_vector {
         if (small || dynamic_storage.unique()) {
             destruct_range(current_begin(), current_end());
         } else {
+            dynamic_buffer tmp(capacity());
+            dynamic_storage.release(size_);
             dynamic_storage.~dynamic_buffer();
-            new(&dynamic_storage) dynamic_buffer(capacity());
+            new(&dynamic_storage) dynamic_buffer(std::move(tmp));
         }
         size_ = 0;
     }
 
     void swap(socow_vector& other) {
         if (!small && !other.small) {
-            std::swap(dynamic_storage, other.dynamic_storage);
+            std::swap(dynamic_storage.m_data, other.dynamic_storage.m_data);
         } else if (small  && other.small) {
             this->swap_small(other);
         } else if (small  && !other.small) {
@@ -173,8 +261,16 @@ struct socow_vector {
     }
 
     iterator insert(const_iterator pos, T const& t) {
+        return emplace(pos, t);
+    }
+    iterator insert(const_iterator pos, T&& t) {
+        return emplace(pos, std::move(t));
+    }
+
+    template <typename... Args>
+    iterator emplace(const_iterator pos, Args&&... args) {
         size_t p = pos - current_begin();
-        push_back(t);
+        emplace_back(std::forward<Args>(args)...);
         for (size_t i = size_ - 1; i > p; i--) {
             std::swap(*(current_begin() + i), *(current_begin() + i - 1));
         }
@@ -199,41 +295,55 @@ struct socow_vector {
     }
 
 private:
+    struct dynamic_buffer;
+
     void create_new_copy() {
         if (!small && !dynamic_storage.unique()) {
-            extend_buffer(capacity(), dynamic_storage.get(), size_);
+            extend_buffer(capacity());
         }
     }
 
-    void extend_buffer(size_t new_capacity, T const* source, size_t count) {
+    void extend_buffer(size_t new_capacity) {
         if (new_capacity == 0) {
             size_ = 0;
             return;
         }
         dynamic_buffer tmp(new_capacity);
-        copy_range(source, tmp.get(), count);
+        relocate(tmp);
+        replace_buffer(tmp);
+    }
+
+    // the elements into the start of tmp: moved when nobody else sees them, copied from a shared buffer
+    void relocate(dynamic_buffer& tmp) {
         if (small || dynamic_storage.unique()) {
-            destruct_range(current_begin(), current_end());
+            move_range(current_begin(), tmp.get(), size_);
+        } else {
+            copy_range(current_begin(), tmp.get(), size_);
         }
-        if (!small) {
+    }
+
+    void replace_buffer(dynamic_buffer& tmp) {
+        if (small) {
+            destruct_range(current_begin(), current_end());
+        } else {
+            dynamic_storage.release(size_);
             dynamic_storage.~dynamic_buffer();
         }
-        new (&dynamic_storage) dynamic_buffer(tmp);
-        size_ = count;
+        new (&dynamic_storage) dynamic_buffer(std::move(tmp));
         small = false;
     }
 
     void swap_to_big(socow_vector& big) {
-        dynamic_buffer tmp = big.dynamic_storage;
+        dynamic_buffer tmp(std::move(big.dynamic_storage));
         big.dynamic_storage.~dynamic_buffer();
         try {
-            copy_range(static_storage, big.static_storage, size_);
+            move_range(static_storage, big.static_storage, size_);
         } catch (...) {
-            new(&big.dynamic_storage) dynamic_buffer(tmp);
+            new(&big.dynamic_storage) dynamic_buffer(std::move(tmp));
             throw;
         }
         destruct_range(current_begin(), current_end());
-        new(&dynamic_storage) dynamic_buffer(tmp);
+        new(&dynamic_storage) dynamic_buffer(std::move(tmp));
     }
 
     void swap_small(socow_vector& b) {
@@ -243,12 +353,12 @@ private:
             i++;
         }
         while (i < size_) {
-            new (b.static_storage + i) T(static_storage[i]);
+            new (b.static_storage + i) T(std::move_if_noexcept(static_storage[i]));
             static_storage[i].~T();
             i++;
         }
         while (i < b.size_) {
-            new (static_storage + i) T(b.static_storage[i]);
+            new (static_storage + i) T(std::move_if_noexcept(b.static_storage[i]));
             b.static_storage[i].~T();
             i++;
         }
@@ -280,6 +390,20 @@ private:
         }
     }
 
+    // like copy_range, but moves when T's move constructor cannot throw, so a failure leaves the source intact
+    void move_range(T* source, T* receiver, size_t count) {
+        size_t i = 0;
+        try {
+            while (i != count) {
+                new (receiver + i) T(std::move_if_noexcept(source[i]));
+                i++;
+            }
+        } catch (...) {
+            destruct_range(receiver, receiver + i);
+            throw;
+        }
+    }
+
     static void destruct_range(T* start, T* end) {
         if (start != nullptr) {
             for (auto it = --end; it >= start; it--) {
@@ -290,29 +414,47 @@ private:
 
     struct metadata {
         size_t capacity_;
-        size_t ref_counter;
+        RefCount ref_counter;
         T data_[];
     };
 
+    // a reference to the buffer; a moved-from or released one holds none
     struct dynamic_buffer {
         metadata* m_data;
 
         explicit dynamic_buffer(size_t cap) : m_data(static_cast<metadata*>(operator new(sizeof(metadata) + sizeof(T) * cap,
                                             static_cast<std::align_val_t>(alignof(metadata))))) {
-            new(&m_data->ref_counter) size_t(1);
+            new(&m_data->ref_counter) RefCount(1);
             new(&m_data->capacity_) size_t(cap);
         }
 
         dynamic_buffer(dynamic_buffer const& other) : m_data(other.m_data) {
-            m_data->ref_counter++;
+            m_data->ref_counter.increment();
+        }
+
+        dynamic_buffer(dynamic_buffer&& other) noexcept : m_data(other.m_data) {
+            other.m_data = nullptr;
         }
 
+        // for buffers without live elements
         ~dynamic_buffer() {
-            if (m_data->ref_counter == 1) {
-                operator delete(m_data, static_cast<std::align_val_t>(alignof(metadata)));
-            } else {
-                m_data->ref_counter--;
+            if (m_data != nullptr && m_data->ref_counter.decrement()) {
+                deallocate(m_data);
+            }
+        }
+
+        // drops the reference; the last one destroys the count elements and frees the buffer
+        void release(size_t count) {
+            if (m_data->ref_counter.decrement()) {
+                destruct_range(m_data->data_, m_data->data_ + count);
+                deallocate(m_data);
             }
+            m_data = nullptr;
+        }
+
+        static void deallocate(metadata* data) {
+            data->ref_counter.~RefCount();
+            operator delete(data, static_cast<std::align_val_t>(alignof(metadata)));
         }
 
         dynamic_buffer& operator=(dynamic_buffer const& other) {
@@ -331,8 +473,8 @@ private:
             return m_data->data_[index];
         }
 
-        size_t unique() {
-            return m_data->ref_counter == 1;
+        bool unique() const {
+            return m_data->ref_counter.unique();
         }
 
         T* get() {
@@ -1,10 +1,15 @@
+#include <string>
+#include <thread>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "gtest/gtest.h"
 
 #include "socow-vector.h"
 
 template struct socow_vector<int, 2>;
+template struct socow_vector<int, 2, socow_atomic_refcount>;
 
 template <typename T>
 T const& as_const(T& obj) {
@@ -1314,3 +1319,215 @@ TEST(small_object, erase_big_into_small_3) {
     EXPECT_THROW(a.erase(as_const(a).begin() + 2, as_const(a).end() - 1),
                  std::runtime_error);
 }
+
+using strings = socow_vector<std::string, 2>;
+
+static_assert(std::is_nothrow_move_constructible<strings>::value);
+static_assert(std::is_nothrow_move_assignable<strings>::value);
+
+TEST(move_semantics, move_ctor) {
+    {
+        container a;
+        for (size_t i = 0; i != 5; ++i)
+            a.push_back(i);
+
+        element<size_t>::set_copy_counter(0);
+        container b(std::move(a));
+        EXPECT_EQ(0, element<size_t>::get_copy_counter());
+        EXPECT_TRUE(a.empty());
+        EXPECT_EQ(5, b.size());
+        for (size_t i = 0; i != 5; ++i)
+            EXPECT_EQ(i, b[i]);
+
+        a.push_back(42);
+        EXPECT_EQ(42, a[0]);
+    }
+    element<size_t>::expect_no_instances();
+}
+
+TEST(move_semantics, move_ctor_small) {
+    strings a;
+    a.push_back(std::string(100, 'a'));
+    char const* data = a[0].data();
+
+    strings b(std::move(a));
+    EXPECT_TRUE(a.empty());
+    EXPECT_EQ(1, b.size());
+    EXPECT_EQ(data, b[0].data());
+}
+
+TEST(move_semantics, move_assignment) {
+    {
+        container a;
+        for (size_t i = 0; i != 5; ++i)
+            a.push_back(i);
+        container b;
+        for (size_t i = 0; i != 3; ++i)
+            b.push_back(42);
+
+        element<size_t>::set_copy_counter(0);
+        b = std::move(a);
+        EXPECT_EQ(0, element<size_t>::get_copy_counter());
+        EXPECT_EQ(5, b.size());
+        EXPECT_EQ(4, b[4]);
+
+        b = std::move(b);
+        EXPECT_EQ(5, b.size());
+    }
+    element<size_t>::expect_no_instances();
+}
+
+TEST(move_semantics, push_back_rvalue) {
+    strings a;
+    std::string s(100, 'a');
+    char const* data = s.data();
+    a.push_back(std::move(s));
+    for (size_t i = 0; i != 100; ++i)
+        a.push_back(std::string(50, 'b'));
+
+    // growth and unsharing of a unique buffer move the strings instead of copying them
+    EXPECT_EQ(data, a[0].data());
+    a.reserve(1000);
+    a.shrink_to_fit();
+    EXPECT_EQ(data, ::as_const(a)[0].data());
+    EXPECT_EQ(101, a.size());
+    EXPECT_EQ(std::string(50, 'b'), a[100]);
+}
+
+TEST(move_semantics, shared_buffer_is_copied) {
+    strings a;
+    for (size_t i = 0; i != 4; ++i)
+        a.push_back(std::string(100, static_cast<char>('a' + i)));
+    strings b = a;
+    char const* data = ::as_const(b)[0].data();
+
+    a.push_back(std::string(100, 'z'));
+    EXPECT_EQ(data, ::as_const(b)[0].data());
+    EXPECT_NE(data, ::as_const(a)[0].data());
+    EXPECT_EQ(4, b.size());
+    EXPECT_EQ(std::string(100, 'a'), ::as_const(a)[0]);
+    EXPECT_EQ(std::string(100, 'z'), ::as_const(a)[4]);
+}
+
+TEST(move_semantics, emplace_back) {
+    socow_vector<std::pair<size_t, std::string>, 2> a;
+    for (size_t i = 0; i != 10; ++i) {
+        auto& p = a.emplace_back(i, std::string(i, 'x'));
+        EXPECT_EQ(&a.back(), &p);
+    }
+    for (size_t i = 0; i != 10; ++i) {
+        EXPECT_EQ(i, a[i].first);
+        EXPECT_EQ(std::string(i, 'x'), a[i].second);
+    }
+}
+
+TEST(move_semantics, emplace_back_from_self) {
+    size_t const N = 500;
+    {
+        container a;
+        a.push_back(42);
+        for (size_t i = 0; i != N; ++i)
+            a.emplace_back(a[a.size() - 1]);
+
+        EXPECT_EQ(N + 1, a.size());
+        for (size_t i = 0; i != a.size(); ++i)
+            EXPECT_EQ(42, a[i]);
+    }
+    element<size_t>::expect_no_instances();
+}
+
+TEST(move_semantics, emplace_back_throw) {
+    {
+        container a;
+        for (size_t i = 0; i != 4; ++i)
+            a.push_back(i);
+        container b = a;
+
+        element<size_t>::set_throw_countdown(3);
+        EXPECT_THROW(a.emplace_back(a[0]), std::runtime_error);
+        element<size_t>::set_throw_countdown(0);
+        EXPECT_EQ(4, a.size());
+        for (size_t i = 0; i != 4; ++i)
+            EXPECT_EQ(i, a[i]);
+    }
+    element<size_t>::expect_no_instances();
+}
+
+TEST(move_semantics, insert_rvalue) {
+    strings a;
+    for (size_t i = 0; i != 5; ++i)
+        a.push_back(std::to_string(i));
+    std::string s(100, 'a');
+    char const* data = s.data();
+    a.insert(::as_const(a).begin() + 2, std::move(s));
+    EXPECT_EQ(6, a.size());
+    EXPECT_EQ(data, a[2].data());
+    EXPECT_EQ("2", a[3]);
+}
+
+using shared_container = socow_vector<element<size_t>, 2, socow_atomic_refcount>;
+using shared_strings = socow_vector<std::string, 2, socow_atomic_refcount>;
+
+TEST(atomic_refcount, copy_on_write) {
+    {
+        shared_container a;
+        for (size_t i = 0; i != 10; ++i)
+            a.push_back(i);
+        shared_container b = a;
+        shared_container c = b;
+        EXPECT_EQ(::as_const(a).data(), ::as_const(c).data());
+
+        b[0] = 100;
+        EXPECT_NE(::as_const(a).data(), ::as_const(b).data());
+        EXPECT_EQ(::as_const(a).data(), ::as_const(c).data());
+        EXPECT_EQ(0, a[0]);
+        EXPECT_EQ(100, b[0]);
+
+        c.shrink_to_fit();
+        c.clear();
+        a.pop_back();
+        shared_container d = std::move(a);
+        EXPECT_EQ(9, d.size());
+        EXPECT_EQ(0, c.size());
+        d.swap(b);
+        EXPECT_EQ(100, d[0]);
+        EXPECT_EQ(9, b.size());
+    }
+    element<size_t>::expect_no_instances();
+}
+
+TEST(atomic_refcount, threads) {
+    size_t const THREADS = 4;
+    size_t const N = 1000;
+    shared_strings snapshot;
+    for (size_t i = 0; i != N; ++i)
+        snapshot.push_back(std::to_string(i));
+
+    std::vector<shared_strings> results(THREADS);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t != THREADS; ++t) {
+        shared_strings copy = snapshot;
+        threads.emplace_back([t, N, copy = std::move(copy), &results]() mutable {
+            for (size_t round = 0; round != 100; ++round) {
+                shared_strings local = copy;
+                EXPECT_EQ(std::to_string(round), ::as_const(local)[round]);
+            }
+            // every thread unshares its copy while the others still read theirs
+            copy[0] = std::to_string(t);
+            copy.push_back("end");
+            results[t] = copy;
+            EXPECT_EQ(N + 1, copy.size());
+        });
+    }
+    snapshot.pop_back();
+    for (std::thread& thread : threads)
+        thread.join();
+
+    EXPECT_EQ(N - 1, snapshot.size());
+    EXPECT_EQ("0", snapshot[0]);
+    for (size_t t = 0; t != THREADS; ++t) {
+        EXPECT_EQ(std::to_string(t), results[t][0]);
+        EXPECT_EQ(std::to_string(N - 1), results[t][N - 1]);
+        EXPECT_EQ("end", results[t][N]);
+    }
+}